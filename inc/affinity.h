@@ -0,0 +1,49 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Thread Affinity Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : affinity.h
+//   Release Version : V1.0
+//   Description :
+//      Pins the OpenMP threads to CPUs so every replica stays on one
+//      NUMA node. Replicas are constructed by the thread that anneals
+//      them, so with pinning their memory is first touched on that node.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Policies:
+//   - compact: fill the CPUs of node 0 first, then node 1, ...
+//   - spread: round robin over the nodes
+//   Only the CPUs in the process affinity mask are used, so taskset and
+//   cgroup limits are respected. Linux only, a no-op elsewhere.
+//
+//############################################################################
+
+#ifndef _AFFINITY_H_
+#define _AFFINITY_H_
+
+#include <string>
+#include <vector>
+
+struct ThreadPlacement {
+    int cpu;
+    int node;
+};
+
+// Affinity mask of the calling thread before `pinThreads`, held by the
+// run that pinned, so concurrent runs do not share it
+struct SavedAffinity {
+    std::vector<int> cpus;      // Empty if nothing was saved
+};
+
+// Pin every thread of the next OpenMP parallel regions of `num_threads`
+// threads, returns false if the affinity could not be set. `placements`
+// is indexed by thread id.
+bool pinThreads(std::string policy, int num_threads, std::vector<ThreadPlacement>& placements, SavedAffinity& saved);
+// Give every thread of the team the mask saved by `pinThreads`
+void unpinThreads(int num_threads, SavedAffinity& saved);
+
+#endif // _AFFINITY_H_
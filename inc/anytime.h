@@ -0,0 +1,84 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Anytime Reporting Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : anytime.h
+//   Release Version : V1.0
+//   Description :
+//      Keeps the output report current while `Lab2` runs, so a batch
+//      scheduler killing it at a deadline still finds a legal floorplan.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Key Features:
+//   1. `AnytimeReport` Class:
+//        - Replicas offer every new legal best. If it beats the global
+//          best and the last snapshot is older than the interval, the
+//          offering thread rewrites the report (temp file + rename).
+//        - A best that arrives inside the interval, or while another
+//          replica is writing, stays pending. Its owner polls at every
+//          temperature step and writes its best solution once the
+//          interval has passed, so the report never lags the true best
+//          by much more than the interval.
+//   2. Graceful stop:
+//        - SIGTERM and SIGINT set a flag that the annealing loops poll
+//          at every temperature step. `main` then writes the best
+//          solution and exits. A second signal terminates at once.
+//        - The handlers are installed by the program (`main`), never by
+//          the library. `runFloorplan` clears the flag when it starts,
+//          so a stop does not carry over to the next run; a program
+//          that runs again after a stop installs the handlers again.
+//
+//############################################################################
+
+#ifndef _ANYTIME_H_
+#define _ANYTIME_H_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include "engine.h"
+
+class AnytimeReport {
+private:
+    std::string filename;
+    double interval;
+    std::chrono::high_resolution_clock::time_point start;
+    std::mutex lock;
+    double best_cost;
+    double last_write;
+    int num_writes;
+    // Best offered but not written yet, `pending_lock` guards the cost
+    std::mutex pending_lock;
+    std::atomic<FloorplanEngine*> pending_engine;
+    double pending_cost;
+
+    double elapsed();
+    void clearPending(double cost);
+
+public:
+    AnytimeReport(std::string f, double i, std::chrono::high_resolution_clock::time_point s)
+        : filename(f), interval(i), start(s), best_cost(1e300), last_write(-1e300), num_writes(0),
+          pending_engine(nullptr), pending_cost(1e300) {}
+
+    int getNumWrites() { return num_writes; }
+
+    // Thread safe. Returns true if a snapshot was written.
+    bool offer(FloorplanEngine* engine, double cost);
+    // Called by a replica between moves, writes its best solution if
+    // it holds the pending best and the interval has passed
+    bool poll(FloorplanEngine* engine);
+    // Round end, no replica running: write `engine`, whose current
+    // solution is its best, regardless of the interval
+    bool flush(FloorplanEngine* engine, double cost);
+};
+
+void installStopHandlers();
+void resetStopRequest();
+bool stopRequested();
+
+#endif // _ANYTIME_H_
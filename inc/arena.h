@@ -0,0 +1,171 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Replica State Arena Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : arena.h
+//   Release Version : V1.0
+//   Description :
+//      Compact storage for the per-replica state touched by the move
+//      loop. Every array of a replica is carved from one cache-line
+//      aligned block, so the working set of a replica is contiguous
+//      and replicas on neighboring cores never share a cache line.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Key Features:
+//   1. `StateArena` Class:
+//        - One 64-byte aligned allocation, zeroed on reset and carved
+//          into arrays that each start on their own cache line.
+//        - Reset reuses the allocation when it is large enough.
+//   2. `IndexArray` Class:
+//        - Block ids or positions 0 ... n, stored as uint16_t while
+//          n < 65536 and as int32_t otherwise. The width is fixed when
+//          the array is bound, hot loops read the typed pointer.
+//   3. `BitArray` Class:
+//        - One bit per entry, e.g. the rotation of every block.
+//
+//############################################################################
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+class StateArena {
+private:
+    char* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+
+public:
+    static const size_t ALIGNMENT = 64;
+
+    StateArena() {}
+    StateArena(const StateArena&) = delete;
+    StateArena& operator=(const StateArena&) = delete;
+    ~StateArena() { std::free(base); }
+
+    template <class T>
+    static size_t bytesFor(size_t count) {
+        return (count * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // Drop every carved array and provide `bytes` of zeroed storage
+    void reset(size_t bytes) {
+        if (bytes > capacity) {
+            std::free(base);
+            void* p = nullptr;
+            if (posix_memalign(&p, ALIGNMENT, bytes) != 0) {
+                throw std::bad_alloc();
+            }
+            base = static_cast<char*>(p);
+            capacity = bytes;
+        }
+        std::memset(base, 0, capacity);
+        used = 0;
+    }
+
+    template <class T>
+    T* carve(size_t count) {
+        T* p = reinterpret_cast<T*>(base + used);
+        used += bytesFor<T>(count);
+        return p;
+    }
+
+    size_t size() { return used; }
+};
+
+class IndexArray {
+private:
+    uint16_t* narrow = nullptr;
+    int32_t* wide = nullptr;
+    int count = 0;
+
+public:
+    static bool fitsNarrow(int max_value) { return max_value < 65536; }
+    static size_t bytesFor(int n, bool is_narrow) {
+        return is_narrow ? StateArena::bytesFor<uint16_t>(n) : StateArena::bytesFor<int32_t>(n);
+    }
+
+    void bind(StateArena& arena, int n, bool is_narrow) {
+        narrow = is_narrow ? arena.carve<uint16_t>(n) : nullptr;
+        wide = is_narrow ? nullptr : arena.carve<int32_t>(n);
+        count = n;
+    }
+
+    int size() const { return count; }
+    bool isNarrow() const { return narrow != nullptr; }
+    uint16_t* data(uint16_t) { return narrow; }
+    int32_t* data(int32_t) { return wide; }
+    const uint16_t* data(uint16_t) const { return narrow; }
+    const int32_t* data(int32_t) const { return wide; }
+
+    int operator[](int i) const { return narrow ? narrow[i] : wide[i]; }
+    void set(int i, int v) {
+        if (narrow) {
+            narrow[i] = v;
+        } else {
+            wide[i] = v;
+        }
+    }
+    void swap(int i, int j) {
+        if (narrow) {
+            std::swap(narrow[i], narrow[j]);
+        } else {
+            std::swap(wide[i], wide[j]);
+        }
+    }
+    // Entries [first, last)
+    void reverse(int first, int last) {
+        if (narrow) {
+            std::reverse(narrow + first, narrow + last);
+        } else {
+            std::reverse(wide + first, wide + last);
+        }
+    }
+    template <class URNG>
+    void shuffle(int first, int last, URNG& rng) {
+        if (narrow) {
+            std::shuffle(narrow + first, narrow + last, rng);
+        } else {
+            std::shuffle(wide + first, wide + last, rng);
+        }
+    }
+    // Both arrays were bound with the same size and width
+    void copyFrom(const IndexArray& other) {
+        if (narrow) {
+            std::memcpy(narrow, other.narrow, count * sizeof(uint16_t));
+        } else {
+            std::memcpy(wide, other.wide, count * sizeof(int32_t));
+        }
+    }
+};
+
+class BitArray {
+private:
+    uint64_t* words = nullptr;
+
+public:
+    static size_t bytesFor(int n) { return StateArena::bytesFor<uint64_t>((n + 63) / 64); }
+
+    void bind(StateArena& arena, int n) { words = arena.carve<uint64_t>((n + 63) / 64); }
+
+    bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+    void assign(int i, bool v) {
+        uint64_t bit = 1ULL << (i & 63);
+        if (v) {
+            words[i >> 6] |= bit;
+        } else {
+            words[i >> 6] &= ~bit;
+        }
+    }
+};
+
+#endif // _ARENA_H_
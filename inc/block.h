@@ -58,9 +58,11 @@
 #include <string>
 #include <vector>
 
+// 64-bit, so coordinates of large dies never overflow. The engines
+// compute in 32 bits when the design bounds allow it, see cost_types.h.
 struct Point {
-    int x;
-    int y;
+    long long x;
+    long long y;
 };
 
 class Terminal {
@@ -91,8 +93,8 @@ public:
 
     void setCoord(Point p)      { coord = p;    }
     void setName(std::string n) { name = n;     }
-    void setCoordX(int x)       { coord.x = x;  }
-    void setCoordY(int y)       { coord.y = y;  }
+    void setCoordX(long long x) { coord.x = x;  }
+    void setCoordY(long long y) { coord.y = y;  }
     void setCoord(int x, int y) {
         coord.x = x;
         coord.y = y;
@@ -130,8 +132,8 @@ public:
     //================================================================
     Point* getCoord()           { return &coord;  }
     Point getMiddle()           { return {coord.x + width / 2, coord.y + height / 2}; }
-    int getCoordX()             { return coord.x; }
-    int getCoordY()             { return coord.y; }
+    long long getCoordX()       { return coord.x; }
+    long long getCoordY()       { return coord.y; }
     int getWidth()              { return width;   }
     int getHeight()             { return height;  }
     std::string getName()       { return name;    }
@@ -141,8 +143,8 @@ public:
     void setWidth(int w)        { width = w;      }
     void setHeight(int h)       { height = h;     }
     void setName(std::string n) { name = n;       }
-    void setCoordX(int x)       { coord.x = x;    }
-    void setCoordY(int y)       { coord.y = y;    }
+    void setCoordX(long long x) { coord.x = x;    }
+    void setCoordY(long long y) { coord.y = y;    }
     void setCoord(int x, int y) { coord = {x, y}; }
     void rotate90()   { std::swap(width, height); rotated = !rotated; }
 };
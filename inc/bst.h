@@ -1,15 +1,43 @@
 #include <bits/stdc++.h>
 
+//================================================================
+// Host trees
+//================================================================
+// Ordered sets over [0, upper_bound] used as the host tree H of the
+// FAST-SP kernel, interchangeable as a template parameter:
+// - FastBitSetTree: flat bitset, linear scans over 64-bit words
+// - HierBitSetTree: bitset plus a summary bitset of non-empty words
+// - FenwickTree: counts in a Fenwick tree, rank and select by descent
+// - VebTree: van Emde Boas tree with 64-bit leaves
+// reset() empties the set and keeps the storage when the bound is the
+// same, so a host can be reused across evaluations.
+//================================================================
+enum HostTreeKind {
+    HOST_FLAT,
+    HOST_HIER,
+    HOST_FENWICK,
+    HOST_VEB,
+    NUM_HOST_TREES
+};
+
+static const char* const HOST_TREE_NAMES[NUM_HOST_TREES] = {"flat", "hier", "fenwick", "veb"};
+
 class FastBitSetTree {
 private:
     std::vector<uint64_t> bits;
     int u;
     
 public:
+    FastBitSetTree() : u(-1) {}
     FastBitSetTree(int upper_bound) : u(upper_bound) {
         int num_blocks = (u + 64) / 64;
         bits.assign(num_blocks, 0);
     }
+
+    void reset(int upper_bound) {
+        u = upper_bound;
+        bits.assign((u + 64) / 64, 0);
+    }
     
     void insert(int value) {
         if (value < 0 || value > u) return;
@@ -93,4 +121,327 @@ public:
         }
         return -1;
     }
-};
\ No newline at end of file
+};
+
+class HierBitSetTree {
+private:
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> summary;  // Bit i set if bits[i] != 0
+    int u;
+
+    // First non-empty word at or after w, -1 if none
+    int nextWord(int w) const {
+        int s = w / 64;
+        if (s >= (int)summary.size()) return -1;
+        uint64_t current = summary[s] & (~0ULL << (w % 64));
+        while (current == 0) {
+            if (++s == (int)summary.size()) return -1;
+            current = summary[s];
+        }
+        return s * 64 + __builtin_ctzll(current);
+    }
+
+    // Last non-empty word at or before w, -1 if none
+    int prevWord(int w) const {
+        if (w < 0) return -1;
+        int s = w / 64;
+        int pos = w % 64;
+        uint64_t current = summary[s] & (pos == 63 ? ~0ULL : ((1ULL << (pos + 1)) - 1));
+        while (current == 0) {
+            if (--s < 0) return -1;
+            current = summary[s];
+        }
+        return s * 64 + 63 - __builtin_clzll(current);
+    }
+
+public:
+    HierBitSetTree() : u(-1) {}
+
+    void reset(int upper_bound) {
+        u = upper_bound;
+        bits.assign((u + 64) / 64, 0);
+        summary.assign((bits.size() + 63) / 64, 0);
+    }
+
+    void insert(int value) {
+        if (value < 0 || value > u) return;
+        bits[value / 64] |= (1ULL << (value % 64));
+        summary[value / 4096] |= (1ULL << ((value / 64) % 64));
+    }
+
+    void remove(int value) {
+        if (value < 0 || value > u) return;
+        int w = value / 64;
+        bits[w] &= ~(1ULL << (value % 64));
+        if (bits[w] == 0) {
+            summary[w / 64] &= ~(1ULL << (w % 64));
+        }
+    }
+
+    int successor(int value) const {
+        if (value >= u) return -1;
+        int w = (value + 1) / 64;
+        uint64_t current = bits[w] & (~0ULL << ((value + 1) % 64));
+        if (current != 0) {
+            return w * 64 + __builtin_ctzll(current);
+        }
+        w = nextWord(w + 1);
+        return w == -1 ? -1 : w * 64 + __builtin_ctzll(bits[w]);
+    }
+
+    int predecessor(int value) const {
+        if (value <= 0) return -1;
+        int w = value / 64;
+        uint64_t current = bits[w] & ((1ULL << (value % 64)) - 1);
+        if (current != 0) {
+            return w * 64 + 63 - __builtin_clzll(current);
+        }
+        w = prevWord(w - 1);
+        return w == -1 ? -1 : w * 64 + 63 - __builtin_clzll(bits[w]);
+    }
+
+    int minimum() const {
+        int w = nextWord(0);
+        return w == -1 ? -1 : w * 64 + __builtin_ctzll(bits[w]);
+    }
+
+    int maximum() const {
+        int w = prevWord(bits.size() - 1);
+        return w == -1 ? -1 : w * 64 + 63 - __builtin_clzll(bits[w]);
+    }
+};
+
+class FenwickTree {
+private:
+    std::vector<int> tree;  // 1-indexed, value v is stored at v+1
+    int u;
+    int size;
+    int count;
+    int top_bit;
+
+    int rank(int value) const {
+        int sum = 0;
+        for (int i = value + 1; i > 0; i -= i & -i) {
+            sum += tree[i];
+        }
+        return sum;
+    }
+
+    // Value of the k-th smallest element, k >= 1
+    int select(int k) const {
+        int pos = 0;
+        for (int step = top_bit; step > 0; step >>= 1) {
+            if (pos + step <= size && tree[pos + step] < k) {
+                pos += step;
+                k -= tree[pos];
+            }
+        }
+        return pos;
+    }
+
+    void add(int value, int delta) {
+        for (int i = value + 1; i <= size; i += i & -i) {
+            tree[i] += delta;
+        }
+    }
+
+public:
+    FenwickTree() : u(-1), size(0), count(0), top_bit(0) {}
+
+    void reset(int upper_bound) {
+        u = upper_bound;
+        size = u + 1;
+        count = 0;
+        tree.assign(size + 1, 0);
+        top_bit = 1;
+        while (top_bit * 2 <= size) top_bit *= 2;
+    }
+
+    // value must not be in the set
+    void insert(int value) {
+        if (value < 0 || value > u) return;
+        add(value, 1);
+        count++;
+    }
+
+    // value must be in the set
+    void remove(int value) {
+        if (value < 0 || value > u) return;
+        add(value, -1);
+        count--;
+    }
+
+    int successor(int value) const {
+        if (value >= u) return -1;
+        int k = rank(value);
+        return k == count ? -1 : select(k + 1);
+    }
+
+    int predecessor(int value) const {
+        if (value <= 0) return -1;
+        int k = rank(value - 1);
+        return k == 0 ? -1 : select(k);
+    }
+
+    int minimum() const {
+        return count == 0 ? -1 : select(1);
+    }
+
+    int maximum() const {
+        return count == 0 ? -1 : select(count);
+    }
+};
+
+class VebTree {
+private:
+    int bits_u;     // Universe is [0, 2^bits_u)
+    int low_bits;
+    int min_v;      // -1 if empty, not stored in the clusters
+    int max_v;
+    uint64_t leaf;  // Whole set when bits_u <= 6
+    std::unique_ptr<VebTree> summary;
+    std::vector<VebTree> clusters;
+
+    bool isLeaf() const { return bits_u <= 6; }
+    int high(int x) const { return x >> low_bits; }
+    int low(int x) const { return x & ((1 << low_bits) - 1); }
+    int index(int h, int l) const { return (h << low_bits) | l; }
+
+    void build(int b) {
+        bits_u = b;
+        min_v = -1;
+        max_v = -1;
+        leaf = 0;
+        if (isLeaf()) return;
+        low_bits = b / 2;
+        summary.reset(new VebTree());
+        summary->build(b - low_bits);
+        clusters.resize(1 << (b - low_bits));
+        for (auto& cluster : clusters) {
+            cluster.build(low_bits);
+        }
+    }
+
+    void clear() {
+        if (min_v == -1) return;
+        if (!isLeaf()) {
+            for (int h = summary->minimum(); h != -1; h = summary->successor(h)) {
+                clusters[h].clear();
+            }
+            summary->clear();
+        }
+        min_v = -1;
+        max_v = -1;
+        leaf = 0;
+    }
+
+    bool empty() const { return min_v == -1; }
+
+public:
+    VebTree() : bits_u(0), low_bits(0), min_v(-1), max_v(-1), leaf(0) {}
+
+    void reset(int upper_bound) {
+        int b = 1;
+        while ((1 << b) <= upper_bound) b++;
+        if (b != bits_u) {
+            build(b);
+        } else {
+            clear();
+        }
+    }
+
+    // value must not be in the set
+    void insert(int x) {
+        if (x < 0 || x >= (1 << bits_u)) return;
+        if (isLeaf()) {
+            leaf |= (1ULL << x);
+            min_v = __builtin_ctzll(leaf);
+            max_v = 63 - __builtin_clzll(leaf);
+            return;
+        }
+        if (min_v == -1) {
+            min_v = max_v = x;
+            return;
+        }
+        if (x < min_v) std::swap(x, min_v);
+        int h = high(x);
+        if (clusters[h].empty()) {
+            summary->insert(h);
+        }
+        clusters[h].insert(low(x));
+        if (x > max_v) max_v = x;
+    }
+
+    // value must be in the set
+    void remove(int x) {
+        if (x < 0 || x >= (1 << bits_u)) return;
+        if (isLeaf()) {
+            leaf &= ~(1ULL << x);
+            min_v = leaf ? __builtin_ctzll(leaf) : -1;
+            max_v = leaf ? 63 - __builtin_clzll(leaf) : -1;
+            return;
+        }
+        if (min_v == max_v) {
+            min_v = max_v = -1;
+            return;
+        }
+        if (x == min_v) {
+            // Pull the smallest clustered element up as the new minimum
+            int h = summary->minimum();
+            x = index(h, clusters[h].minimum());
+            min_v = x;
+        }
+        int h = high(x);
+        clusters[h].remove(low(x));
+        if (clusters[h].empty()) {
+            summary->remove(h);
+            if (x == max_v) {
+                int sh = summary->maximum();
+                max_v = sh == -1 ? min_v : index(sh, clusters[sh].maximum());
+            }
+        } else if (x == max_v) {
+            max_v = index(h, clusters[h].maximum());
+        }
+    }
+
+    int successor(int x) const {
+        if (isLeaf()) {
+            if (x >= 63) return -1;
+            uint64_t current = leaf & (~0ULL << (x + 1));
+            return current ? __builtin_ctzll(current) : -1;
+        }
+        if (min_v != -1 && x < min_v) return min_v;
+        int h = high(x);
+        int l = low(x);
+        int cluster_max = clusters[h].maximum();
+        if (cluster_max != -1 && l < cluster_max) {
+            return index(h, clusters[h].successor(l));
+        }
+        int sh = summary->successor(h);
+        return sh == -1 ? -1 : index(sh, clusters[sh].minimum());
+    }
+
+    int predecessor(int x) const {
+        if (isLeaf()) {
+            if (x <= 0) return -1;
+            uint64_t current = leaf & ((1ULL << std::min(x, 63)) - 1);
+            if (x > 63) current = leaf;
+            return current ? 63 - __builtin_clzll(current) : -1;
+        }
+        if (max_v != -1 && x > max_v) return max_v;
+        int h = high(x);
+        int l = low(x);
+        int cluster_min = clusters[h].minimum();
+        if (cluster_min != -1 && l > cluster_min) {
+            return index(h, clusters[h].predecessor(l));
+        }
+        int ph = summary->predecessor(h);
+        if (ph == -1) {
+            return (min_v != -1 && x > min_v) ? min_v : -1;
+        }
+        return index(ph, clusters[ph].maximum());
+    }
+
+    int minimum() const { return min_v; }
+    int maximum() const { return max_v; }
+};
@@ -0,0 +1,128 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   B*-Tree Engine Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : bstar.h
+//   Release Version : V1.0
+//   Description :
+//      B*-tree floorplan engine. The design (blocks, nets, outline, cost
+//      function and report writer) is borrowed from a `FastSP` instance,
+//      only the representation and the moves differ.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Key Features:
+//   1. Packing:
+//        - The left child of a node is placed right of it, the right
+//          child above it at the same x. y comes from the contour of the
+//          blocks placed so far, in DFS order.
+//        - The contour is a linked list of horizontal segments. A child
+//          starts its scan at the segment of its parent, which begins at
+//          or left of the child, so a block only walks the segments
+//          below its own span.
+//   2. Moves:
+//        - Rotate a block, swap two blocks, or delete a block and
+//          reinsert it as a child of another node. Rotations and swaps
+//          are undone in place, node moves journal the links they change.
+//   3. Annealing:
+//        - Same schedule and acceptance rules as `FastSP::runFastSP`.
+//
+//############################################################################
+
+#ifndef _BSTAR_H_
+#define _BSTAR_H_
+
+#include <string>
+#include <vector>
+#include "engine.h"
+#include "fast_sp.h"
+
+struct BStarNodes {
+    int root;
+    std::vector<int> parent;
+    std::vector<int> left;
+    std::vector<int> right;
+    std::vector<int> block_of;   // Block placed at each node
+    std::vector<int> node_of;    // Node holding each block
+};
+
+struct ContourSegment {
+    long long x1;
+    long long x2;
+    long long y;
+    int prev;
+    int next;
+};
+
+class BStarTree : public FloorplanEngine {
+private:
+    //================================================================
+    // Member Variables
+    //================================================================
+    FastSP* design;
+    std::vector<Block*> blocks;
+    int num_blocks;
+    Outline outline;
+
+    BStarNodes tree;
+    BStarNodes best_tree;
+    std::vector<char> best_rotated;
+    // Links overwritten by the last node move and their old values
+    std::vector<std::pair<int*, int>> undo_links;
+
+    // Segments are appended and unlinked, never reused within a pack,
+    // so a node keeps the index of the segment it was placed on
+    std::vector<long long> node_x;
+    std::vector<int> node_segment;
+    std::vector<int> pack_stack;
+    std::vector<ContourSegment> contour;
+    int contour_head;
+
+    RngEngine rng;
+    RandomBatch<RngEngine> batch;
+
+    //================================================================
+    // Moves
+    //================================================================
+    // `kind` 0: rotate block i, 1: swap the blocks at nodes i and j,
+    // 2: move node i under node j
+    struct Move {
+        int kind;
+        int i;
+        int j;
+    };
+    Move randomMove();
+    void applyMove(const Move& move);
+    void undoMove(const Move& move);
+    void setLink(int& link, int value);
+    void moveNode(int p, int target, bool as_left);
+    int appendSegment(long long x1, long long x2, long long y);
+    long long placeOnContour(int from, long long x, int w, int h, int& placed);
+    void snapshotBest();
+    void revertToBest();
+
+public:
+    // Takes ownership of `d`, which holds the design
+    BStarTree(FastSP* d);
+    ~BStarTree() override { delete design; }
+
+    std::string getEngineName() override { return "bstar"; }
+    FastSP* getDesign() { return design; }
+
+    //================================================================
+    // B*-Tree Algorithm
+    //================================================================
+    void initialize();
+    std::pair<long long, long long> pack();
+    double run(double runtime, long long max_iterations) override;
+    void copySolution(FloorplanEngine* other) override;
+    std::pair<long long, long long> place() override { return pack(); }
+    void outputDump(std::string filename, double runtime) override;
+    void writeSnapshot(std::string filename, double runtime) override;
+    void writeBestSnapshot(std::string filename, double runtime) override;
+};
+
+#endif // _BSTAR_H_
@@ -0,0 +1,54 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Annealing Checkpoint Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : checkpoint.h
+//   Release Version : V1.0
+//   Description :
+//      Saves and restores the state of all `FastSP` replicas between
+//      annealing rounds, so a preempted run can continue with `--resume`
+//      instead of starting over from `initialize()`.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Layout (native endianness):
+//   1. Header:
+//        - char[4] "FSPC", uint32 version, uint32 rng engine (see
+//          RNG_ENGINE_ID), int32 num_replicas, int32 num_blocks,
+//          int32 next_round, int32 best_index
+//        - Older versions and files of the other engine are rejected.
+//   2. Per replica:
+//        - double last round cost, uint32 state length, followed by
+//          `FastSP::saveState`
+//
+//   Loading only reads the replica states into buffers. Each replica
+//   restores its own with `loadReplicaState` on the thread that anneals
+//   it, so its arena is first touched on that thread's NUMA node.
+//
+//   The global best is the replica at `best_index`; after every round
+//   its solution has been copied to all other replicas.
+//
+//############################################################################
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include "fast_sp.h"
+
+struct Checkpoint {
+    int next_round;
+    int best_index;
+    std::vector<double> costs;
+    std::vector<std::string> states;    // Serialized replicas, see loadReplicaState
+};
+
+bool saveCheckpoint(std::string filename, std::vector<FastSP*>& replicas, const Checkpoint& ckpt);
+bool loadCheckpoint(std::string filename, std::vector<FastSP*>& replicas, Checkpoint& ckpt);
+bool loadReplicaState(FastSP* replica, const std::string& state);
+
+#endif // _CHECKPOINT_H_
@@ -0,0 +1,84 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Cost Types Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : cost_types.h
+//   Release Version : V1.0
+//   Description :
+//      Integer types of the packing and cost pipeline, passed to the
+//      `FastSP` kernels as one template parameter.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Types:
+//   - Coord: positions and packing lengths (BUCKL in FAST-SP)
+//   - Area:  len_x * len_y of any packing, legal or not
+//   - Wire:  total HPWL of the netlist
+//   `Cost32` is used when the design bounds fit in 32 bits. If only
+//   the lengths fit, `CostMixed` keeps 32-bit coordinates and widens
+//   the area and the wirelength. `Cost64` is left for the rest, see
+//   `FastSP::selectCostTypes`.
+//
+//   Cost Policies:
+//   - AreaCost:  alpha * area, for alpha == 1 or designs without nets
+//   - WireCost:  (1 - alpha) * HPWL, for alpha == 0
+//   - MixedCost: alpha * area + (1 - alpha) * HPWL
+//   The annealer is instantiated per policy, so a dropped term is not
+//   evaluated at all, see `FastSP::selectCostModel`.
+//
+//############################################################################
+
+#ifndef _COST_TYPES_H_
+#define _COST_TYPES_H_
+
+#include <cstdint>
+
+template <class CoordT, class AreaT, class WireT>
+struct CostTypes {
+    typedef CoordT Coord;
+    typedef AreaT Area;
+    typedef WireT Wire;
+};
+
+typedef CostTypes<int32_t, int32_t, int32_t> Cost32;
+typedef CostTypes<int32_t, int64_t, int64_t> CostMixed;
+typedef CostTypes<int64_t, int64_t, int64_t> Cost64;
+
+// Ordered from narrowest to widest
+enum CostWidth {
+    COST_WIDTH_32,
+    COST_WIDTH_MIXED,
+    COST_WIDTH_64,
+    NUM_COST_WIDTHS
+};
+
+static const char* const COST_WIDTH_NAMES[NUM_COST_WIDTHS] = {"32", "mixed", "64"};
+
+enum CostModel {
+    COST_MIXED,
+    COST_AREA,
+    COST_WIRE,
+    NUM_COST_MODELS
+};
+
+static const char* const COST_MODEL_NAMES[NUM_COST_MODELS] = {"mixed", "area", "wirelength"};
+
+struct MixedCost {
+    static const bool area = true;
+    static const bool wire = true;
+};
+
+struct AreaCost {
+    static const bool area = true;
+    static const bool wire = false;
+};
+
+struct WireCost {
+    static const bool area = false;
+    static const bool wire = true;
+};
+
+#endif // _COST_TYPES_H_
@@ -0,0 +1,66 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Floorplan Engine Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : engine.h
+//   Release Version : V1.0
+//   Description :
+//      Common interface of the packing engines driven by the round loop
+//      in `floorplan.cpp`, so replicas can be annealed, synchronized and
+//      written out without knowing the representation.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Engines:
+//   1. `FastSP`: sequence pair packed by FAST-SP (default)
+//   2. `BStarTree`: B*-tree packed along a contour
+//
+//############################################################################
+
+#ifndef _ENGINE_H_
+#define _ENGINE_H_
+
+#include <string>
+#include <utility>
+
+class AnytimeReport;
+
+class FloorplanEngine {
+public:
+    virtual ~FloorplanEngine() {}
+
+    virtual std::string getEngineName() = 0;
+
+    // Anneal for `runtime` seconds, or `max_iterations` temperature
+    // steps if > 0. Returns the best legal cost, DBL_MAX if none.
+    virtual double run(double runtime, long long max_iterations) = 0;
+
+    // Take over the solution of a replica of the same engine
+    virtual void copySolution(FloorplanEngine* other) = 0;
+
+    // Pack the current solution into the block coordinates of the
+    // design, returns the chip width and height
+    virtual std::pair<long long, long long> place() = 0;
+
+    virtual void outputDump(std::string filename, double runtime) = 0;
+
+    // Quietly write the current solution, called from the replica's
+    // thread right after it found a new best
+    virtual void writeSnapshot(std::string filename, double runtime) = 0;
+
+    // Quietly write the best solution of the running anneal, called
+    // from the replica's thread between moves. Leaves the current
+    // solution as it was.
+    virtual void writeBestSnapshot(std::string filename, double runtime) = 0;
+
+    // Anytime reporting, see anytime.h
+    void setAnytime(AnytimeReport* a) { anytime = a; }
+
+protected:
+    AnytimeReport* anytime = nullptr;
+};
+
+#endif // _ENGINE_H_
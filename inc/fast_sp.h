@@ -7,8 +7,16 @@
 #include <string>
 #include <unordered_map>
 #include <random>
+#include <iostream>
+#include <atomic>
 #include "bst.h"
 #include "block.h"
+#include "rng.h"
+#include "engine.h"
+#include "cost_types.h"
+#include "arena.h"
+
+class ParetoArchive;
 
 
 struct Outline {
@@ -21,18 +29,62 @@ struct SequencePair {
     std::vector<int> y;
 };
 
+// Sequence pair held by a replica, carved from its state arena.
+// `SequencePair` is the copy handed to and taken from other modules.
+struct CompactSequencePair {
+    IndexArray x;
+    IndexArray y;
+};
+
+// A block of a previous report, see FastSP::readWarmStart
+struct WarmPlacement {
+    int id;
+    long long x1, y1, x2, y2;
+};
+
 struct LastMove {
     int i;
     int j;
     int action;
 };
 
+// Fixed-capacity move record, proposing a move never allocates
+struct MoveList {
+    static const int CAPACITY = 8;
+    LastMove moves[CAPACITY];
+    int size;
+};
+
+// Sequence pair positions and rotated blocks changed since the last
+// best snapshot. Each entry is recorded once, tracked by its dirty flag,
+// so n+1 entries always suffice.
+struct MoveJournal {
+    IndexArray x;
+    IndexArray y;
+    IndexArray rot;
+    int num_x = 0;
+    int num_y = 0;
+    int num_rot = 0;
+    char* dirty_x = nullptr;
+    char* dirty_y = nullptr;
+    char* dirty_rot = nullptr;
+};
+
+// Best solution broadcast to the other replicas after a round
+struct SolutionMessage {
+    uint64_t tag;
+    int num_blocks;
+    std::vector<uint16_t> order16;  // X then Y, if num_blocks < 65536
+    std::vector<int32_t> order32;   // X then Y otherwise
+    std::vector<uint64_t> rotated;  // One bit per block
+};
+
 struct Indice {
     int x;
     int y;
 };
 
-class FastSP {
+class FastSP : public FloorplanEngine {
 private:
     //================================================================
     // Member Variables
@@ -44,27 +96,71 @@ private:
     std::vector<Net*> nets;
     std::unordered_map<std::string, Block*> blockMap;
     std::unordered_map<std::string, Terminal*> terminalMap;
-    SequencePair sp;
+    CompactSequencePair sp;
     int num_terminals;
     int num_blocks;
     int num_nets;
     std::vector<int> pos_x;
     std::vector<int> pos_y;
 
-    int seed = 1337;
-    std::mt19937 rng;
+    // Host trees and buffers of evalSequencePair
+    HostTreeKind host_kind = HOST_FLAT;
+    FastBitSetTree flat_host;
+    HierBitSetTree hier_host;
+    FenwickTree fenwick_host;
+    VebTree veb_host;
+    IndexArray eval_match;
+    int64_t* eval_buckl = nullptr;      // Sized for 64-bit coordinates
+    int32_t* bucklBuffer(int32_t) { return reinterpret_cast<int32_t*>(eval_buckl); }
+    int64_t* bucklBuffer(int64_t) { return eval_buckl; }
+
+    // Cost32, CostMixed or Cost64, see selectCostTypes
+    CostWidth cost_width = COST_WIDTH_32;
+    // Terms of the cost function, see selectCostModel
+    CostModel cost_model = COST_MIXED;
+    // Total HPWL of the last cost evaluated with a wirelength term
+    long long last_wirelength = 0;
+    // Receives every accepted legal packing, see pareto.h
+    ParetoArchive* archive = nullptr;
+
+    uint32_t seed = 1337;
+    bool seeded = false;
+    RngEngine rng;
+    RandomBatch<RngEngine> batch;
+    double init_temp = 10000.0;
+    // Set with the starting temperature of a warm start, which then
+    // also caps the reheats so they do not scramble the solution
+    bool warm_started = false;
+    long long evaluated_moves = 0;
+
+    // Best solution of the current run, kept in sync through the journal
+    CompactSequencePair best_sp;
+    BitArray best_rotated;
+    MoveJournal journal;
+
+    // Backs sp, best_sp, best_rotated, journal and the buffers of
+    // evalSequencePair, see layoutState
+    StateArena state;
+
+    // Identifies the solution a replica holds, copies between replicas
+    // holding the same solution are skipped
+    uint64_t solution_tag = 0;
+    static std::atomic<uint64_t> next_solution_tag;
 
 public:
     //================================================================
     // Constructors and Destructors
     //================================================================
-    FastSP() : alpha(1.0), outline({0, 0}) {}
-    FastSP(double a) : alpha(a), outline({0, 0}) {}
-    FastSP(double a, std::string block_file, std::string net_file) : alpha(a), outline({0, 0}) {
+    FastSP() : alpha(1.0), outline({0, 0}), num_terminals(0), num_blocks(0), num_nets(0) {}
+    FastSP(double a) : alpha(a), outline({0, 0}), num_terminals(0), num_blocks(0), num_nets(0) {}
+    FastSP(double a, Outline o) : alpha(a), outline(o), num_terminals(0), num_blocks(0), num_nets(0) {}
+    FastSP(double a, std::string block_file, std::string net_file) : alpha(a), outline({0, 0}), num_terminals(0), num_blocks(0), num_nets(0) {
         loadBlocks(block_file);
         loadNets(net_file);
+        selectCostTypes();
+        selectCostModel();
     }
-    ~FastSP() {
+    ~FastSP() override {
         for (int i = 0; i < num_blocks; i++) {
             delete blocks[i];
         }
@@ -81,38 +177,112 @@ public:
     //================================================================
     double getAlpha() { return alpha; }
     Outline getOutline() { return outline; }
-    void setAlpha(double a) { alpha = a; }
+    void setAlpha(double a) { alpha = a; selectCostModel(); }
     void setOutline(Outline o) { outline = o; }
+    uint32_t getSeed() { return seed; }
+    void setSeed(uint32_t s) { seed = s; seeded = true; }
+    int getNumBlocks() { return num_blocks; }
+    std::vector<Block*>& getBlocks() { return blocks; }
+    std::vector<Terminal*>& getTerminals() { return terminals; }
+    std::vector<Net*>& getNets() { return nets; }
+    SequencePair getSequencePair();
+    void setSequencePair(const SequencePair& s);
+    HostTreeKind getHostTree() { return host_kind; }
+    void setHostTree(HostTreeKind kind) { host_kind = kind; }
+    CostWidth getCostWidth() { return cost_width; }
+    void setCostWidth(CostWidth width) { cost_width = width; }
+    CostWidth selectCostTypes();
+    CostModel getCostModel() { return cost_model; }
+    CostModel selectCostModel();
+    void setCostModel(CostModel model) { cost_model = model; }
+    void setArchive(ParetoArchive* a) { archive = a; }
+    long long getEvaluatedMoves() { return evaluated_moves; }
+    double getInitTemp() { return init_temp; }
+    void setInitTemp(double t) { init_temp = t; warm_started = true; }
+    bool isWarmStarted() { return warm_started; }
 
     //================================================================
     // Loaders
     //================================================================
     void loadBlocks(std::string filename);
     void loadNets(std::string filename);
+    void addBlock(std::string name, int w, int h);
+    void addTerminal(std::string name, int x, int y);
+    void addNet(const std::vector<std::string>& pins);
+    void addNet(const std::vector<int>& block_ids, const std::vector<int>& terminal_ids);
 
     //================================================================
     // FastSP Algorithm
     //================================================================
-    double runFastSP(double runtime);
-    std::pair<int, int> initialize();
-    std::vector<LastMove> randomAction(int depth);
+    double runFastSP(double runtime, long long max_iterations = 0);
+    template <class T, class P>
+    double anneal(double runtime, long long max_iterations);
+    template <class T>
+    double annealWith(double runtime, long long max_iterations);
+    double run(double runtime, long long max_iterations) override { return runFastSP(runtime, max_iterations); }
+    std::pair<long long, long long> initialize();
+    std::pair<long long, long long> initializeShelf();
+    bool warmStart(std::string filename);
+    bool readWarmStart(std::string filename, std::vector<WarmPlacement>& placed);
+    void warmStart(const std::vector<WarmPlacement>& placed);
+    void layoutState();
+    void resetSequencePair();
+    void setSolution(const SequencePair& s, const std::vector<char>& rotated);
+    void initRng();
+    MoveList randomAction(int depth);
+    void perturb(int depth);
     void swapSingle(bool do_y_or_x, int i, int j);
     void swapBoth(int i, int j);
     void rotate90(int i);
-    void undoAction(std::vector<LastMove>& last_moves);
-    int evalSequencePair(bool do_y_or_x);
-    int netHPWL(Net* net);
-    int totalHPWL();
+    void applyAction(const LastMove& move);
+    void undoAction(MoveList& last_moves);
+    void journalMove(const LastMove& move);
+    void snapshotBest();
+    void commitBest();
+    void revertToBest();
+    static uint64_t freshSolutionTag() { return ++next_solution_tag; }
+    void newSolutionTag() { solution_tag = freshSolutionTag(); }
+    std::vector<int> criticalBlocks(long long len_x, long long len_y);
+    int compact(long long max_placements, double time_limit = 0);
+    long long evalSequencePair(bool do_y_or_x);
+    template <class Coord>
+    Coord evalSequencePairAs(bool do_y_or_x);
+    template <class Coord, class HostTree>
+    Coord evalSequencePairWith(HostTree& host, bool do_y_or_x);
+    template <class Coord, class Index, class HostTree>
+    Coord evalSequencePairKernel(HostTree& host, bool do_y_or_x);
+    HostTreeKind calibrateHostTree(double budget, std::vector<double>& evals_per_sec);
+    long long netHPWL(Net* net);
+    long long totalHPWL();
+    template <class T>
+    typename T::Wire netHPWLAs(Net* net);
+    template <class T>
+    typename T::Wire totalHPWLAs();
+    template <class T, class P>
+    double costAs(typename T::Coord len_x, typename T::Coord len_y);
+    template <class T>
+    double costWith(typename T::Coord len_x, typename T::Coord len_y);
 
     //================================================================
     // Utility Functions
     //================================================================
     SequencePair deepCopySP(SequencePair& sp);
-    double costFunction(int len_x, int len_y);
+    double costFunction(long long len_x, long long len_y);
     void outputBlocks(std::string filename);
     void outputHPWL(std::string filename);
-    void outputDump(std::string filename, double runtime);
+    bool writeReport(std::string filename, double runtime, long long len_x, long long len_y, bool verbose = true);
+    std::pair<long long, long long> place() override;
+    void outputDump(std::string filename, double runtime) override;
+    void writeSnapshot(std::string filename, double runtime) override;
+    void writeBestSnapshot(std::string filename, double runtime) override;
     void copySolution(FastSP* other);
+    void packSolution(SolutionMessage& message);
+    void copySolution(const SolutionMessage& message);
+    void copySolution(FloorplanEngine* other) override { copySolution(static_cast<FastSP*>(other)); }
+    std::string getEngineName() override { return "sp"; }
+    void saveState(std::ostream& out);
+    bool loadState(std::istream& in);
+    static uint32_t splitSeed(uint64_t master_seed, int index);
 };
 
 
@@ -0,0 +1,170 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Floorplanning Library Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : floorplan.h
+//   Release Version : V1.0
+//   Description :
+//      Embeddable entry point of the floorplanner (`libfloorplan.a`).
+//      A design is passed in memory, annealed by parallel replicas of
+//      the selected engine and the placement is returned in memory.
+//      `Lab2` is a command line front end over this API.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Key Features:
+//   1. Design input:
+//        - Blocks, terminals and nets as arrays, net pins by index into
+//          the block and terminal arrays, no names are looked up.
+//        - `loadDesign` fills the same structure from .block/.nets files.
+//   2. Run:
+//        - Every option of the command line, files (report, snapshots,
+//          checkpoints) are only touched when their name is set.
+//        - Output on std::cout only with `verbose`, errors always go to
+//          std::cerr.
+//   3. Result:
+//        - Lower-left corner, placed size and rotation of every block,
+//          in the order of the design, plus the chip size and cost.
+//   4. Alpha sweep:
+//        - Replicas anneal with different alphas and feed one archive
+//          of non-dominated (area, HPWL) legal solutions. With a report
+//          name `out.rpt`, the archive is written to `out.paretoK.rpt`
+//          and summarized in `out.pareto.txt`.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Usage Example:
+//   #include "floorplan.h"
+//
+//   FloorplanDesign design;
+//   design.alpha = 0.5;
+//   design.outline_width = 100;
+//   design.outline_height = 100;
+//   design.blocks = {{"a", 40, 30}, {"b", 20, 50}};
+//   design.terminals = {{"p", 0, 0}};
+//   design.nets = {{{0, 1}, {0}}};  // a, b and p
+//
+//   FloorplanOptions options;
+//   options.num_threads = 4;
+//   options.round_time = 0.5;
+//   FloorplanResult result;
+//   if (runFloorplan(design, options, result) && result.legal) {
+//       // result.blocks[i].x, .y, .width, .height, .rotated
+//   }
+//
+//############################################################################
+
+#ifndef _FLOORPLAN_H_
+#define _FLOORPLAN_H_
+
+#include <string>
+#include <vector>
+
+struct FloorplanBlock {
+    std::string name;
+    int width;
+    int height;
+};
+
+struct FloorplanTerminal {
+    std::string name;
+    int x;
+    int y;
+};
+
+struct FloorplanNet {
+    std::vector<int> blocks;    // Indices into FloorplanDesign::blocks
+    std::vector<int> terminals; // Indices into FloorplanDesign::terminals
+};
+
+struct FloorplanDesign {
+    double alpha = 0.5;
+    int outline_width = 0;
+    int outline_height = 0;
+    std::vector<FloorplanBlock> blocks;
+    std::vector<FloorplanTerminal> terminals;
+    std::vector<FloorplanNet> nets;
+};
+
+// Default compaction budget in block placements. Packing runs at 17-24
+// million placements per second on ami49 and vda317b, so the pass
+// stays under 100 ms.
+const long long COMPACT_PLACEMENTS = 1500000;
+
+struct FloorplanOptions {
+    int num_threads = 0;                // Replicas, 0: omp_get_max_threads()
+    int num_rounds = 10;
+    double round_time = 28.5;           // Seconds per round
+    long long max_iterations = 0;       // If > 0, temperature steps per round instead
+    bool seeded = false;
+    unsigned long long seed = 0;
+    std::string engine = "sp";          // sp or bstar
+    std::string host_tree = "auto";     // auto, flat, hier, fenwick or veb
+    std::string cost_bits = "auto";     // auto, 32, mixed or 64
+    std::string pin_policy;             // Empty, compact or spread
+    std::string init_mode = "shelf";    // shelf or random
+    std::string warm_start_file;
+    double warm_temp = 1000.0;
+    bool multilevel = false;
+    int ml_target = 32;
+    double ml_level_time = 2.0;
+    std::string checkpoint_file;
+    int checkpoint_every = 1;
+    std::string resume_file;
+    std::string worker_address;         // Island worker of this coordinator
+    int migrate_every = 1;
+    double compact_time = 0.1;          // Seconds, 0 disables compaction, unseeded runs only
+    long long compact_placements = 0;   // Block placements, 0: COMPACT_PLACEMENTS
+    std::string report_file;            // Final report and snapshots, if set
+    double snapshot_interval = 1.0;
+    bool snapshots = true;
+    std::vector<double> sweep_alphas;   // Alpha sweep if not empty, see runFloorplan
+    int pareto_size = 32;               // Capacity of the sweep archive
+    bool verbose = true;
+};
+
+struct FloorplanPlacement {
+    long long x;
+    long long y;
+    int width;                          // As placed, swapped if rotated
+    int height;
+    bool rotated;
+};
+
+struct FloorplanParetoPoint {
+    long long area;
+    long long wirelength;
+    long long width;
+    long long height;
+    double alpha;                       // Sweep alpha of the replica that found it
+    std::vector<FloorplanPlacement> blocks;
+};
+
+struct FloorplanResult {
+    bool legal = false;                 // Fits the outline
+    double cost = 0.0;
+    long long width = 0;
+    long long height = 0;
+    long long wirelength = 0;
+    double runtime = 0.0;               // Seconds
+    std::vector<FloorplanPlacement> blocks;
+    std::vector<FloorplanParetoPoint> pareto; // Sweep archive, by area ascending
+};
+
+// Read .block/.nets files. Returns false if no block could be read.
+bool loadDesign(double alpha, std::string block_file, std::string net_file, FloorplanDesign& design);
+
+// Returns false on invalid designs or options, and if a resume or an
+// island worker connection fails
+bool runFloorplan(const FloorplanDesign& design, const FloorplanOptions& options, FloorplanResult& result);
+
+// Serve `num_workers` island workers (`runFloorplan` with
+// `worker_address`) of the design, see island.h, and write their best
+// solution to `report_file`
+bool runFloorplanCoordinator(const FloorplanDesign& design, std::string address, int num_workers,
+                             std::string topology, std::string report_file, double accept_timeout, double exchange_timeout);
+
+#endif // _FLOORPLAN_H_
@@ -0,0 +1,88 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Multi-Process Island Model Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : island.h
+//   Release Version : V1.0
+//   Description :
+//      Coordinator/worker mode for running one design on several `Lab2`
+//      processes. Every worker runs its own OpenMP `FastSP` replicas and
+//      periodically exchanges its best sequence pair with a coordinator
+//      over TCP (`host:port`) or a Unix socket (`unix:/path`).
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Protocol:
+//   Every message is a header {uint32 magic, uint32 type, uint32 length}
+//   followed by `length` payload bytes, in native endianness. Lengths
+//   above the size of the expected message are rejected.
+//   1. HELLO   (worker -> coordinator): int32 num_blocks, int32 outline
+//      width, int32 outline height, double alpha. Workers that differ
+//      from the coordinator's design in any of them are rejected.
+//   2. WELCOME (coordinator -> worker): int32 worker_id, int32 num_workers
+//   3. BEST    (worker -> coordinator): solution, answered by MIGRANT
+//   4. MIGRANT (coordinator -> worker): solution picked by the topology
+//   5. DONE    (worker -> coordinator): final solution, no answer
+//   A solution is double cost, int32 n, int32 x[n], int32 y[n] and the
+//   rotation bits of the n blocks, 8 per byte.
+//
+//   Topologies:
+//   - star: every worker receives the global best
+//   - ring: worker i receives the latest best of worker i-1
+//
+//############################################################################
+
+#ifndef _ISLAND_H_
+#define _ISLAND_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "fast_sp.h"
+
+static const uint32_t ISLAND_MAGIC = 0x49505346; // "FSPI"
+
+struct IslandSolution {
+    double cost;
+    SequencePair sp;
+    std::vector<char> rotated;
+};
+
+IslandSolution captureSolution(FastSP* fastsp, double cost);
+
+// One framed message on a connected socket, see Protocol above. A
+// payload longer than `max_length` fails before it is allocated.
+bool sendMessage(int fd, uint32_t type, const std::string& payload);
+bool recvMessage(int fd, uint32_t& type, std::string& payload, size_t max_length);
+
+class IslandWorker {
+private:
+    int fd;
+    int worker_id;
+    int num_workers;
+
+public:
+    IslandWorker() : fd(-1), worker_id(-1), num_workers(0) {}
+    ~IslandWorker();
+
+    int getWorkerId() { return worker_id; }
+    int getNumWorkers() { return num_workers; }
+
+    bool connect(std::string address, FastSP* fastsp);
+    bool exchange(const IslandSolution& mine, IslandSolution& migrant);
+    bool finish(const IslandSolution& mine);
+};
+
+// Serve `num_workers` workers until all of them are done, then write the
+// best solution of the design in `fastsp` to `output_file`
+// Fails if fewer than `num_workers` workers connect within
+// `accept_timeout` seconds. A worker that sends nothing for
+// `exchange_timeout` seconds (0 for no limit) is dropped.
+bool runCoordinator(std::string address, int num_workers, std::string topology,
+                    FastSP* fastsp, std::string output_file, double accept_timeout, double exchange_timeout);
+
+#endif // _ISLAND_H_
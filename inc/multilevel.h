@@ -0,0 +1,54 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Multilevel Floorplanning Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : multilevel.h
+//   Release Version : V1.0
+//   Description :
+//      Multilevel mode for large designs. Blocks are clustered level by
+//      level, the coarsest clusters are floorplanned with `FastSP`, and
+//      the result is projected back and refined level by level.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Key Features:
+//   1. Coarsening:
+//        - Heavy-edge matching on the netlist, weighted by how similar
+//          the two cluster areas are. Clusters without connected
+//          partners are paired with the next cluster of similar area.
+//        - A cluster places its two children side by side or stacked,
+//          each possibly rotated, whichever wastes the least area.
+//   2. Uncoarsening:
+//        - Every cluster in X and Y is replaced by its two children in
+//          the order of their relative placement, so the projected
+//          sequence pair reproduces the coarse packing.
+//        - Rotating a cluster transposes it: side by side becomes
+//          stacked and the children are rotated as well.
+//
+//############################################################################
+
+#ifndef _MULTILEVEL_H_
+#define _MULTILEVEL_H_
+
+#include <vector>
+#include "fast_sp.h"
+
+struct MultilevelOptions {
+    int num_replicas;           // Parallel replicas per level
+    int target_clusters;        // Stop coarsening at this many clusters
+    double level_time;          // Time budget per level in seconds
+    long long level_iterations; // If > 0, temperature steps per level instead
+    double refine_temp;         // Starting temperature of refinement levels
+    bool seeded;
+    unsigned long long master_seed;
+    bool verbose;               // Progress of the levels on std::cout
+};
+
+// Floorplan the design of `flat` through the coarser levels. Returns the
+// projected solution for the flat design, which is left untouched.
+bool runMultilevel(FastSP* flat, const MultilevelOptions& opt, SequencePair& sp, std::vector<char>& rotated);
+
+#endif // _MULTILEVEL_H_
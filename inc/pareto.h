@@ -0,0 +1,70 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Pareto Archive Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : pareto.h
+//   Release Version : V1.0
+//   Description :
+//      Archive of non-dominated (area, HPWL) legal solutions for alpha
+//      sweeps. Every replica offers each legal packing it accepts to
+//      its own archive, whatever alpha it anneals with, and the
+//      archives are merged between rounds.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Key Features:
+//   1. Dominance:
+//        - Entries are sorted by area ascending, so HPWL is strictly
+//          descending. An offer is dominated iff the entry with the
+//          largest area not above its own has an HPWL not above its
+//          own, a binary search.
+//        - The solution is only packed when the offer is kept.
+//   2. Capacity:
+//        - Beyond `capacity` entries, the interior entry whose
+//          neighbors are closest (normalized area + HPWL gap) is
+//          dropped, so the extremes always stay.
+//
+//############################################################################
+
+#ifndef _PARETO_H_
+#define _PARETO_H_
+
+#include <algorithm>
+#include <vector>
+#include "fast_sp.h"
+
+struct ParetoEntry {
+    long long area;
+    long long wirelength;
+    long long width;
+    long long height;
+    double alpha;               // Alpha of the replica that found it
+    SolutionMessage solution;   // Tagged uniquely, see FastSP::freshSolutionTag
+};
+
+class ParetoArchive {
+private:
+    size_t capacity;
+    std::vector<ParetoEntry> entries;
+
+    void thin();
+
+public:
+    ParetoArchive(size_t c) : capacity(std::max<size_t>(c, 2)) {}
+
+    std::vector<ParetoEntry>& getEntries() { return entries; }
+    void clear() { entries.clear(); }
+
+    bool dominated(long long area, long long wirelength);
+    // Pack the current solution of `fastsp` if it is not dominated
+    bool offer(FastSP* fastsp, long long width, long long height, long long wirelength);
+    // Same, crediting the solution to the replica alpha that found it
+    bool offer(FastSP* fastsp, long long width, long long height, long long wirelength, double alpha);
+    bool insert(const ParetoEntry& entry);
+    void merge(const ParetoArchive& other);
+};
+
+#endif // _PARETO_H_
@@ -0,0 +1,169 @@
+//############################################################################
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Random Number Generation Header File
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   File Name   : rng.h
+//   Release Version : V1.0
+//   Description :
+//      Random number generation for the annealing loop.
+//
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   Key Features:
+//   1. `Xoshiro256pp` Class:
+//        - xoshiro256++ generator, a drop-in UniformRandomBitGenerator
+//          that is several times faster than std::mt19937.
+//        - Streams its state like the standard engines, so it can be
+//          stored in checkpoints.
+//   2. `RngEngine` Type:
+//        - Engine used by `FastSP`. Define FASTSP_RNG_MT19937 to fall
+//          back to std::mt19937_64.
+//   3. `RandomBatch` Class:
+//        - Pre-generates block indices, actions and acceptance uniforms
+//          in fixed-size buffers, so the move loop only reads arrays.
+//
+//############################################################################
+
+#ifndef _RNG_H_
+#define _RNG_H_
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+
+class Xoshiro256pp {
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    typedef uint64_t result_type;
+
+    Xoshiro256pp() { seed(1337); }
+    explicit Xoshiro256pp(uint64_t value) { seed(value); }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+
+    // Expand the seed with SplitMix64, as recommended by the authors
+    void seed(uint64_t value) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t z = (value += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Xoshiro256pp& rng) {
+        return os << rng.s[0] << ' ' << rng.s[1] << ' ' << rng.s[2] << ' ' << rng.s[3];
+    }
+
+    friend std::istream& operator>>(std::istream& is, Xoshiro256pp& rng) {
+        return is >> rng.s[0] >> rng.s[1] >> rng.s[2] >> rng.s[3];
+    }
+};
+
+// Recorded in checkpoints, an RNG state only loads into the engine that wrote it
+enum RngEngineId : uint32_t {
+    RNG_XOSHIRO256PP = 1,
+    RNG_MT19937_64 = 2,
+};
+
+#ifdef FASTSP_RNG_MT19937
+typedef std::mt19937_64 RngEngine;
+static const RngEngineId RNG_ENGINE_ID = RNG_MT19937_64;
+#else
+typedef Xoshiro256pp RngEngine;
+static const RngEngineId RNG_ENGINE_ID = RNG_XOSHIRO256PP;
+#endif
+
+template <class Engine>
+class RandomBatch {
+private:
+    static const int SIZE = 256;
+
+    int indices[SIZE];
+    int actions[SIZE];
+    double uniforms[SIZE];
+    int index_pos;
+    int action_pos;
+    int uniform_pos;
+    uint32_t range;
+
+    // Map the upper 32 bits to [1, range] by multiply-shift
+    void refillIndices(Engine& rng) {
+        for (int i = 0; i < SIZE; i += 2) {
+            uint64_t r = rng();
+            indices[i] = 1 + (int)(((r >> 32) * range) >> 32);
+            indices[i+1] = 1 + (int)(((r & 0xFFFFFFFFULL) * range) >> 32);
+        }
+        index_pos = 0;
+    }
+
+    // 32 actions in [0, 3] per draw
+    void refillActions(Engine& rng) {
+        for (int i = 0; i < SIZE; i += 32) {
+            uint64_t r = rng();
+            for (int j = 0; j < 32; j++) {
+                actions[i+j] = (r >> (2 * j)) & 3;
+            }
+        }
+        action_pos = 0;
+    }
+
+    // 53-bit uniforms in [0, 1)
+    void refillUniforms(Engine& rng) {
+        for (int i = 0; i < SIZE; i++) {
+            uniforms[i] = (rng() >> 11) * (1.0 / 9007199254740992.0);
+        }
+        uniform_pos = 0;
+    }
+
+public:
+    RandomBatch() : index_pos(SIZE), action_pos(SIZE), uniform_pos(SIZE), range(1) {}
+
+    // Drop all buffered draws, so the stream only depends on the engine
+    void reset(int num_indices) {
+        range = num_indices;
+        index_pos = SIZE;
+        action_pos = SIZE;
+        uniform_pos = SIZE;
+    }
+
+    int index(Engine& rng) {
+        if (index_pos == SIZE) refillIndices(rng);
+        return indices[index_pos++];
+    }
+
+    int action(Engine& rng) {
+        if (action_pos == SIZE) refillActions(rng);
+        return actions[action_pos++];
+    }
+
+    double uniform(Engine& rng) {
+        if (uniform_pos == SIZE) refillUniforms(rng);
+        return uniforms[uniform_pos++];
+    }
+};
+
+#endif // _RNG_H_
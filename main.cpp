@@ -1,12 +1,48 @@
 #include <iostream>
-#include <chrono>
-#include <vector>
-#include <omp.h>
-#include "fast_sp.h"
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include "floorplan.h"
+#include "anytime.h"
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <alpha> <block_file> <net_file> <output_file> [options]" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --seed <n>         Master seed, split per thread (reproducible runs)" << std::endl;
+    std::cerr << "  --iterations <n>   Temperature steps per round instead of a time budget" << std::endl;
+    std::cerr << "  --checkpoint <f>   Write all replica states to <f> after every round" << std::endl;
+    std::cerr << "  --checkpoint-every <n>  Checkpoint every <n> rounds instead (default 1)" << std::endl;
+    std::cerr << "  --resume <f>       Continue from checkpoint <f> instead of initializing" << std::endl;
+    std::cerr << "  --engine <e>       Packing engine: sp (sequence pair, default) or bstar (B*-tree)" << std::endl;
+    std::cerr << "  --host-tree <t>    FAST-SP host tree: auto (default), flat, hier, fenwick or veb" << std::endl;
+    std::cerr << "  --cost-bits <b>    Coordinate/cost width: auto (default), 32, mixed or 64" << std::endl;
+    std::cerr << "  --pin <policy>     Pin OpenMP threads to CPUs: compact or spread over NUMA nodes" << std::endl;
+    std::cerr << "  --init <mode>      Initial sequence pair: shelf (default) or random" << std::endl;
+    std::cerr << "  --warm-start <f>   Derive the initial sequence pair from a previous report <f>" << std::endl;
+    std::cerr << "  --warm-temp <t>    Starting temperature of a warm start (default 1000)" << std::endl;
+    std::cerr << "  --multilevel       Experimental: cluster the design and floorplan it coarse to fine first" << std::endl;
+    std::cerr << "  --ml-target <n>    Number of clusters on the coarsest level (default 32)" << std::endl;
+    std::cerr << "  --ml-level-time <s>  Time budget per coarse level in seconds (default 2)" << std::endl;
+    std::cerr << "  --coordinator <a>  Serve island workers on host:port or unix:/path" << std::endl;
+    std::cerr << "  --workers <n>      Number of workers the coordinator waits for (default 2)" << std::endl;
+    std::cerr << "  --topology <t>     Migration topology: star (default) or ring" << std::endl;
+    std::cerr << "  --accept-timeout <s>  Seconds the coordinator waits for its workers (default 300)" << std::endl;
+    std::cerr << "  --exchange-timeout <s>  Seconds the coordinator waits for a worker's next solution (default 600, 0: no limit)" << std::endl;
+    std::cerr << "  --worker <a>       Run as island worker of the coordinator at <a>" << std::endl;
+    std::cerr << "  --migrate-every <n>  Exchange solutions every <n> rounds (default 1)" << std::endl;
+    std::cerr << "  --compact-time <ms>  Time limit of the final compaction pass in unseeded runs (default 100, 0 disables)" << std::endl;
+    std::cerr << "  --compact-placements <n>  Block placements the compaction pass may spend (default 1500000)" << std::endl;
+    std::cerr << "  --snapshot-interval <s>  Minimum time between anytime report snapshots (default 1)" << std::endl;
+    std::cerr << "  --no-snapshots     Write the report only at the end" << std::endl;
+    std::cerr << "  --sweep <a,b,...>  Anneal replicas with these alphas and keep a Pareto front of area vs. HPWL" << std::endl;
+    std::cerr << "  --pareto-size <n>  Maximum number of solutions on the Pareto front (default 32)" << std::endl;
+    std::cerr << "  --rounds <n>       Number of annealing rounds (default 10)" << std::endl;
+    std::cerr << "  --round-time <s>   Time budget of each round in seconds (default 28.5)" << std::endl;
+}
 
 int main(int argc, char* argv[]) {
-    if (argc != 5) {
-        std::cerr << "Usage: " << argv[0] << " <alpha> <block_file> <net_file> <output_file>" << std::endl;
+    if (argc < 5) {
+        printUsage(argv[0]);
         return 1;
     }
 
@@ -15,66 +51,128 @@ int main(int argc, char* argv[]) {
     std::string net_file = argv[3];
     std::string output_file = argv[4];
 
-    int num_runs = omp_get_max_threads();
-
-    std::vector<double> costs(num_runs);
-    std::vector<FastSP*> fastsp_instances(num_runs);
-
-    auto start = std::chrono::high_resolution_clock::now();
-
-    #pragma omp parallel for
-    for (int i = 0; i < num_runs; ++i) {
-        FastSP* fastsp = new FastSP(alpha, block_file, net_file);
-        fastsp->initialize();
-        fastsp_instances[i] = fastsp;
-    }
-
-    for (int i = 0; i < 10; ++i) {
-        #pragma omp parallel for
-        for (int j = 0; j < num_runs; ++j) {
-            double cost = fastsp_instances[j]->runFastSP(28.5);
-            costs[j] = cost;
+    FloorplanOptions opt;
+    opt.report_file = output_file;
+    std::string coordinator_address;
+    int num_workers = 2;
+    std::string topology = "star";
+    double accept_timeout = 300.0;
+    double exchange_timeout = 600.0;
+    bool coordinator_options = false;
+    std::string run_option;
+    for (int i = 5; i < argc; ++i) {
+        std::string arg = argv[i];
+        // Annealing options are the workers' business, the coordinator
+        // would ignore them
+        if (run_option.empty() && arg != "--coordinator" && arg != "--workers" && arg != "--topology" &&
+            arg != "--accept-timeout" && arg != "--exchange-timeout") {
+            run_option = arg;
         }
-        // Find the best solution
-        // Copy the best solution to all instances
-        // Run the instances again
-        double min_cost = costs[0];
-        int min_index = 0;
-        for (int j = 1; j < num_runs; ++j) {
-            if (costs[j] < min_cost) {
-                min_cost = costs[j];
-                min_index = j;
+        if (arg == "--seed" && i + 1 < argc) {
+            opt.seeded = true;
+            opt.seed = std::stoull(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opt.max_iterations = std::stoll(argv[++i]);
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            opt.checkpoint_file = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            opt.checkpoint_every = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--resume" && i + 1 < argc) {
+            opt.resume_file = argv[++i];
+        } else if (arg == "--engine" && i + 1 < argc) {
+            opt.engine = argv[++i];
+        } else if (arg == "--host-tree" && i + 1 < argc) {
+            opt.host_tree = argv[++i];
+        } else if (arg == "--cost-bits" && i + 1 < argc) {
+            opt.cost_bits = argv[++i];
+        } else if (arg == "--pin" && i + 1 < argc) {
+            opt.pin_policy = argv[++i];
+        } else if (arg == "--init" && i + 1 < argc) {
+            opt.init_mode = argv[++i];
+        } else if (arg == "--warm-start" && i + 1 < argc) {
+            opt.warm_start_file = argv[++i];
+        } else if (arg == "--warm-temp" && i + 1 < argc) {
+            opt.warm_temp = std::stod(argv[++i]);
+        } else if (arg == "--multilevel") {
+            opt.multilevel = true;
+        } else if (arg == "--ml-target" && i + 1 < argc) {
+            opt.ml_target = std::max(2, std::stoi(argv[++i]));
+        } else if (arg == "--ml-level-time" && i + 1 < argc) {
+            opt.ml_level_time = std::stod(argv[++i]);
+        } else if (arg == "--coordinator" && i + 1 < argc) {
+            coordinator_address = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            num_workers = std::max(1, std::stoi(argv[++i]));
+            coordinator_options = true;
+        } else if (arg == "--topology" && i + 1 < argc) {
+            topology = argv[++i];
+            coordinator_options = true;
+            if (topology != "star" && topology != "ring") {
+                std::cerr << "Error: Unknown topology " << topology << std::endl;
+                return 1;
             }
-        }
-
-        std::cout << "Min Cost: " << min_cost << std::endl;
-
-        for (int j = 0; j < num_runs; ++j) {
-            if (j != min_index) {
-                fastsp_instances[j]->copySolution(fastsp_instances[min_index]);
+        } else if (arg == "--accept-timeout" && i + 1 < argc) {
+            accept_timeout = std::max(0.0, std::stod(argv[++i]));
+            coordinator_options = true;
+        } else if (arg == "--exchange-timeout" && i + 1 < argc) {
+            exchange_timeout = std::max(0.0, std::stod(argv[++i]));
+            coordinator_options = true;
+        } else if (arg == "--worker" && i + 1 < argc) {
+            opt.worker_address = argv[++i];
+        } else if (arg == "--migrate-every" && i + 1 < argc) {
+            opt.migrate_every = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--compact-time" && i + 1 < argc) {
+            opt.compact_time = std::max(0.0, std::stod(argv[++i])) / 1000.0;
+        } else if (arg == "--compact-placements" && i + 1 < argc) {
+            opt.compact_placements = std::max(0LL, std::stoll(argv[++i]));
+        } else if (arg == "--snapshot-interval" && i + 1 < argc) {
+            opt.snapshot_interval = std::max(0.0, std::stod(argv[++i]));
+        } else if (arg == "--no-snapshots") {
+            opt.snapshots = false;
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            std::istringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                opt.sweep_alphas.push_back(std::stod(item));
             }
+        } else if (arg == "--pareto-size" && i + 1 < argc) {
+            opt.pareto_size = std::max(2, std::stoi(argv[++i]));
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            opt.num_rounds = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--round-time" && i + 1 < argc) {
+            opt.round_time = std::stod(argv[++i]);
+        } else {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
         }
     }
 
+    if (coordinator_options && coordinator_address.empty()) {
+        std::cerr << "Error: --workers, --topology, --accept-timeout and --exchange-timeout need --coordinator" << std::endl;
+        return 1;
+    }
+    if (!coordinator_address.empty() && !run_option.empty()) {
+        std::cerr << "Error: " << run_option << " cannot be combined with --coordinator, pass it to the workers" << std::endl;
+        return 1;
+    }
 
-    double min_cost = costs[0];
-    int min_index = 0;
-    for (int i = 1; i < num_runs; ++i) {
-        if (costs[i] < min_cost) {
-            min_cost = costs[i];
-            min_index = i;
-        }
+    FloorplanDesign design;
+    if (!loadDesign(alpha, block_file, net_file, design)) {
+        return 1;
     }
 
-    auto stop = std::chrono::high_resolution_clock::now();
-    double runtime = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+    if (!coordinator_address.empty()) {
+        bool ok = runFloorplanCoordinator(design, coordinator_address, num_workers, topology, output_file, accept_timeout, exchange_timeout);
+        return ok ? 0 : 1;
+    }
 
-    fastsp_instances[min_index]->outputDump(output_file, runtime);
-    std::cout << "Elapsed: " << runtime << " Sec" << std::endl;
+    installStopHandlers();
 
-    for (int i = 0; i < num_runs; ++i) {
-        delete fastsp_instances[i];
+    FloorplanResult result;
+    if (!runFloorplan(design, opt, result)) {
+        return 1;
     }
-
+    std::cout << "Elapsed: " << result.runtime << " Sec" << std::endl;
     return 0;
-}
\ No newline at end of file
+}
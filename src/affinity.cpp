@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <omp.h>
+#include "affinity.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// NUMA node of a CPU from sysfs, 0 if the kernel does not report one
+static int cpuNode(int cpu) {
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+    int node = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+            node = std::stoi(name.substr(4));
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+bool pinThreads(std::string policy, int num_threads, std::vector<ThreadPlacement>& placements, SavedAffinity& saved) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        std::cerr << "Error: Unable to read the CPU affinity mask" << std::endl;
+        return false;
+    }
+    saved.cpus.clear();
+    std::vector<ThreadPlacement> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus.push_back({cpu, cpuNode(cpu)});
+            saved.cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        return false;
+    }
+
+    // Compact: by node, then CPU. Spread: the k-th CPU of every node
+    // before the (k+1)-th of any node.
+    std::stable_sort(cpus.begin(), cpus.end(), [](const ThreadPlacement& a, const ThreadPlacement& b) {
+        return a.node < b.node;
+    });
+    if (policy == "spread") {
+        std::vector<ThreadPlacement> by_rank;
+        std::vector<int> rank(cpus.size());
+        for (size_t i = 0; i < cpus.size(); i++) {
+            rank[i] = (i > 0 && cpus[i].node == cpus[i-1].node) ? rank[i-1] + 1 : 0;
+        }
+        std::vector<size_t> order(cpus.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return rank[a] < rank[b];
+        });
+        for (size_t i : order) {
+            by_rank.push_back(cpus[i]);
+        }
+        cpus = by_rank;
+    }
+
+    placements.assign(num_threads, {-1, -1});
+    bool ok = true;
+    #pragma omp parallel num_threads(num_threads) reduction(&&:ok)
+    {
+        int tid = omp_get_thread_num();
+        ThreadPlacement target = cpus[tid % cpus.size()];
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(target.cpu, &mask);
+        ok = sched_setaffinity(0, sizeof(mask), &mask) == 0;
+        if (ok) {
+            placements[tid] = target;
+        }
+    }
+    if (!ok) {
+        std::cerr << "Error: Unable to pin the OpenMP threads" << std::endl;
+    }
+    return ok;
+}
+
+void unpinThreads(int num_threads, SavedAffinity& saved) {
+    if (saved.cpus.empty()) {
+        return;
+    }
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : saved.cpus) {
+        CPU_SET(cpu, &mask);
+    }
+    #pragma omp parallel num_threads(num_threads)
+    {
+        sched_setaffinity(0, sizeof(mask), &mask);
+    }
+    saved.cpus.clear();
+}
+
+#else
+
+bool pinThreads(std::string policy, int num_threads, std::vector<ThreadPlacement>& placements, SavedAffinity& saved) {
+    (void)policy;
+    (void)num_threads;
+    placements.clear();
+    saved.cpus.clear();
+    std::cerr << "Warning: Thread pinning is only supported on Linux" << std::endl;
+    return false;
+}
+
+void unpinThreads(int num_threads, SavedAffinity& saved) {
+    (void)num_threads;
+    saved.cpus.clear();
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include <csignal>
+#include "anytime.h"
+
+static volatile std::sig_atomic_t stop_signal = 0;
+
+static void handleStop(int sig) {
+    stop_signal = sig;
+    // A second signal falls through to the default action
+    std::signal(sig, SIG_DFL);
+}
+
+void installStopHandlers() {
+    std::signal(SIGTERM, handleStop);
+    std::signal(SIGINT, handleStop);
+}
+
+// A stop only ends the run it arrived in. The handlers are the
+// caller's business, they are never touched here.
+void resetStopRequest() {
+    stop_signal = 0;
+}
+
+bool stopRequested() {
+    return stop_signal != 0;
+}
+
+double AnytimeReport::elapsed() {
+    return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Forget the pending best once a snapshot at least as good is on disk
+void AnytimeReport::clearPending(double cost) {
+    std::lock_guard<std::mutex> guard(pending_lock);
+    if (cost <= pending_cost) {
+        pending_engine = nullptr;
+        pending_cost = 1e300;
+    }
+}
+
+bool AnytimeReport::offer(FloorplanEngine* engine, double cost) {
+    {
+        std::lock_guard<std::mutex> guard(pending_lock);
+        if (cost < pending_cost) {
+            pending_engine = engine;
+            pending_cost = cost;
+        }
+    }
+    // Never stall a replica behind another one that is writing
+    std::unique_lock<std::mutex> guard(lock, std::try_to_lock);
+    if (!guard.owns_lock() || cost >= best_cost) {
+        return false;
+    }
+    double now = elapsed();
+    if (now - last_write < interval) {
+        return false;
+    }
+    engine->writeSnapshot(filename, now);
+    best_cost = cost;
+    last_write = now;
+    num_writes++;
+    clearPending(cost);
+    return true;
+}
+
+// The owner writes its best solution rather than the current one, it
+// may have annealed away from it since the offer
+bool AnytimeReport::poll(FloorplanEngine* engine) {
+    if (pending_engine.load(std::memory_order_relaxed) != engine) {
+        return false;
+    }
+    std::unique_lock<std::mutex> guard(lock, std::try_to_lock);
+    if (!guard.owns_lock()) {
+        return false;
+    }
+    double now = elapsed();
+    if (now - last_write < interval) {
+        return false;
+    }
+    double cost;
+    {
+        std::lock_guard<std::mutex> pending_guard(pending_lock);
+        if (pending_engine != engine || pending_cost >= best_cost) {
+            return false;
+        }
+        cost = pending_cost;
+    }
+    engine->writeBestSnapshot(filename, now);
+    best_cost = cost;
+    last_write = now;
+    num_writes++;
+    clearPending(cost);
+    return true;
+}
+
+bool AnytimeReport::flush(FloorplanEngine* engine, double cost) {
+    std::lock_guard<std::mutex> guard(lock);
+    // The pending best belongs to this round, replicas start the next
+    // one from fresh bests
+    {
+        std::lock_guard<std::mutex> pending_guard(pending_lock);
+        pending_engine = nullptr;
+        pending_cost = 1e300;
+    }
+    if (cost >= best_cost) {
+        return false;
+    }
+    double now = elapsed();
+    engine->writeSnapshot(filename, now);
+    best_cost = cost;
+    last_write = now;
+    num_writes++;
+    return true;
+}
@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include "bstar.h"
+#include "anytime.h"
+
+BStarTree::BStarTree(FastSP* d) : design(d) {
+    blocks = design->getBlocks();
+    num_blocks = design->getNumBlocks();
+    outline = design->getOutline();
+    design->initRng();
+    rng = RngEngine(design->getSeed());
+    node_x.assign(num_blocks, 0);
+    node_segment.assign(num_blocks, 0);
+}
+
+//================================================================
+// Initialization
+//================================================================
+// Rows of the outline width, tallest blocks first. Each row is a
+// chain of left children, the first block of a row is the right child
+// of the first block of the row below.
+//================================================================
+void BStarTree::initialize() {
+    std::vector<int> order(num_blocks);
+    for (int i = 0; i < num_blocks; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return blocks[a]->getHeight() > blocks[b]->getHeight();
+    });
+
+    tree.root = num_blocks > 0 ? 0 : -1;
+    tree.parent.assign(num_blocks, -1);
+    tree.left.assign(num_blocks, -1);
+    tree.right.assign(num_blocks, -1);
+    tree.block_of = order;
+    tree.node_of.assign(num_blocks, -1);
+    for (int p = 0; p < num_blocks; p++) {
+        tree.node_of[order[p]] = p;
+    }
+    int row_start = 0;
+    int row_width = 0;
+    for (int p = 0; p < num_blocks; p++) {
+        int w = blocks[order[p]]->getWidth();
+        if (p == 0) {
+            row_width = w;
+        } else if (row_width + w <= outline.width) {
+            tree.left[p-1] = p;
+            tree.parent[p] = p-1;
+            row_width += w;
+        } else {
+            tree.right[row_start] = p;
+            tree.parent[p] = row_start;
+            row_start = p;
+            row_width = w;
+        }
+    }
+}
+
+//================================================================
+// Packing
+//================================================================
+int BStarTree::appendSegment(long long x1, long long x2, long long y) {
+    contour.push_back({x1, x2, y, -1, -1});
+    return contour.size() - 1;
+}
+
+// Returns the y of a block spanning [x, x+w) and raises the contour
+// under it to y + h. The scan starts at segment `from`, which must
+// begin at or left of x. `placed` receives the new segment of the block.
+long long BStarTree::placeOnContour(int from, long long x, int w, int h, int& placed) {
+    long long x2 = x + w;
+    int first = from;
+    while (contour[first].x2 <= x) {
+        first = contour[first].next;
+    }
+    int last = first;
+    long long y = contour[first].y;
+    while (contour[last].next != -1 && contour[last].x2 < x2) {
+        last = contour[last].next;
+        y = std::max(y, contour[last].y);
+    }
+
+    // Replace first ... last by the uncovered rest of first, the block
+    // and the uncovered rest of last
+    int before = contour[first].prev;
+    int after = contour[last].next;
+    int left = -1;
+    int right = -1;
+    if (contour[first].x1 < x) {
+        left = appendSegment(contour[first].x1, x, contour[first].y);
+    }
+    if (contour[last].x2 > x2) {
+        right = appendSegment(x2, contour[last].x2, contour[last].y);
+    }
+    placed = appendSegment(x, x2, y + h);
+    int chain[3] = {left, placed, right};
+    int prev = before;
+    for (int s : chain) {
+        if (s == -1) {
+            continue;
+        }
+        contour[s].prev = prev;
+        if (prev == -1) {
+            contour_head = s;
+        } else {
+            contour[prev].next = s;
+        }
+        prev = s;
+    }
+    contour[prev].next = after;
+    if (after != -1) {
+        contour[after].prev = prev;
+    }
+    return y;
+}
+
+std::pair<long long, long long> BStarTree::pack() {
+    contour.clear();
+    contour_head = appendSegment(0, LLONG_MAX, 0);
+    long long len_x = 0;
+    long long len_y = 0;
+    if (tree.root == -1) {
+        return {0, 0};
+    }
+
+    // Preorder: node, left subtree, right subtree. A node's segment
+    // stays linked until its right child is placed, since its left
+    // subtree lies right of it.
+    pack_stack.clear();
+    pack_stack.push_back(tree.root);
+    node_x[tree.root] = 0;
+    node_segment[tree.root] = contour_head;
+    while (!pack_stack.empty()) {
+        int p = pack_stack.back();
+        pack_stack.pop_back();
+        Block* block = blocks[tree.block_of[p]];
+        long long x = node_x[p];
+        int w = block->getWidth();
+        int h = block->getHeight();
+        int placed;
+        long long y = placeOnContour(node_segment[p], x, w, h, placed);
+        block->setCoordX(x);
+        block->setCoordY(y);
+        len_x = std::max(len_x, x + w);
+        len_y = std::max(len_y, y + h);
+        if (tree.right[p] != -1) {
+            node_x[tree.right[p]] = x;
+            node_segment[tree.right[p]] = placed;
+            pack_stack.push_back(tree.right[p]);
+        }
+        if (tree.left[p] != -1) {
+            node_x[tree.left[p]] = x + w;
+            node_segment[tree.left[p]] = placed;
+            pack_stack.push_back(tree.left[p]);
+        }
+    }
+    return {len_x, len_y};
+}
+
+//================================================================
+// Moves
+//================================================================
+BStarTree::Move BStarTree::randomMove() {
+    int kind = batch.action(rng);
+    int i = batch.index(rng) - 1;
+    int j = batch.index(rng) - 1;
+    while (j == i) {
+        j = batch.index(rng) - 1;
+    }
+    // Action 3 maps to a node move, so moves are drawn twice as often
+    // as rotations and swaps
+    return {std::min(kind, 2), i, j};
+}
+
+void BStarTree::applyMove(const Move& move) {
+    if (move.kind == 0) {
+        blocks[move.i]->rotate90();
+    } else if (move.kind == 1) {
+        std::swap(tree.block_of[move.i], tree.block_of[move.j]);
+        std::swap(tree.node_of[tree.block_of[move.i]], tree.node_of[tree.block_of[move.j]]);
+    } else {
+        undo_links.clear();
+        moveNode(move.i, move.j, batch.action(rng) & 1);
+    }
+}
+
+void BStarTree::undoMove(const Move& move) {
+    if (move.kind == 0) {
+        blocks[move.i]->rotate90();
+    } else if (move.kind == 1) {
+        std::swap(tree.block_of[move.i], tree.block_of[move.j]);
+        std::swap(tree.node_of[tree.block_of[move.i]], tree.node_of[tree.block_of[move.j]]);
+    } else {
+        for (size_t k = undo_links.size(); k-- > 0;) {
+            *undo_links[k].first = undo_links[k].second;
+        }
+        undo_links.clear();
+    }
+}
+
+// Every link a node move writes goes through here, so the move can be
+// undone in O(changed links)
+void BStarTree::setLink(int& link, int value) {
+    undo_links.push_back({&link, link});
+    link = value;
+}
+
+// Delete the block at node p and reinsert it as the left or right child
+// of the node holding the block of `target`. A node with two children
+// is emptied by pulling the blocks of its left-most path up first.
+void BStarTree::moveNode(int p, int target, bool as_left) {
+    int block = tree.block_of[p];
+    int target_block = tree.block_of[target];
+    while (tree.left[p] != -1 && tree.right[p] != -1) {
+        int c = tree.left[p];
+        setLink(tree.block_of[p], tree.block_of[c]);
+        setLink(tree.node_of[tree.block_of[c]], p);
+        p = c;
+    }
+
+    int child = tree.left[p] != -1 ? tree.left[p] : tree.right[p];
+    int up = tree.parent[p];
+    if (child != -1) {
+        setLink(tree.parent[child], up);
+    }
+    if (up == -1) {
+        setLink(tree.root, child);
+    } else if (tree.left[up] == p) {
+        setLink(tree.left[up], child);
+    } else {
+        setLink(tree.right[up], child);
+    }
+
+    // The target block may have been pulled up into another node
+    int t = tree.node_of[target_block];
+    setLink(tree.parent[p], t);
+    setLink(tree.block_of[p], block);
+    setLink(tree.node_of[block], p);
+    if (as_left) {
+        setLink(tree.left[p], tree.left[t]);
+        setLink(tree.right[p], -1);
+        setLink(tree.left[t], p);
+        if (tree.left[p] != -1) {
+            setLink(tree.parent[tree.left[p]], p);
+        }
+    } else {
+        setLink(tree.right[p], tree.right[t]);
+        setLink(tree.left[p], -1);
+        setLink(tree.right[t], p);
+        if (tree.right[p] != -1) {
+            setLink(tree.parent[tree.right[p]], p);
+        }
+    }
+}
+
+void BStarTree::snapshotBest() {
+    best_tree = tree;
+    best_rotated.resize(num_blocks);
+    for (int i = 0; i < num_blocks; i++) {
+        best_rotated[i] = blocks[i]->isRotated();
+    }
+}
+
+void BStarTree::revertToBest() {
+    tree = best_tree;
+    for (int i = 0; i < num_blocks; i++) {
+        if (blocks[i]->isRotated() != (bool)best_rotated[i]) {
+            blocks[i]->rotate90();
+        }
+    }
+}
+
+//================================================================
+// B*-Tree Algorithm
+//================================================================
+// Simulated annealing with the schedule and acceptance rules of
+// `FastSP::runFastSP`, see there for the three phases.
+//================================================================
+double BStarTree::run(double runtime, long long max_iterations) {
+    long long best_x, best_y;
+    std::tie(best_x, best_y) = pack();
+    double best_cost = design->costFunction(best_x, best_y);
+    double overall_best_cost = best_cost;
+
+    double init_temp = design->getInitTemp();
+    double temp = init_temp;
+    double reforge_temp = 1800.0+num_blocks*10;
+    if (design->isWarmStarted()) {
+        reforge_temp = std::min(reforge_temp, init_temp);
+    }
+    double rate = 0.9999;
+    int step_per_temp = 10;
+    long long best_size = best_x*best_y;
+    bool solution_found = best_x <= outline.width && best_y <= outline.height;
+    bool overall_solution_found = solution_found;
+    snapshotBest();
+    if (num_blocks < 2) {
+        return overall_solution_found ? overall_best_cost : DBL_MAX;
+    }
+
+    batch.reset(num_blocks);
+    auto start = std::chrono::high_resolution_clock::now();
+    int i = 0;
+    int finish_count = 0;
+
+    while (1) {
+        i++;
+        for (int j = 0; j < step_per_temp; j++) {
+            Move move = randomMove();
+            applyMove(move);
+            long long len_x, len_y;
+            std::tie(len_x, len_y) = pack();
+            double cost = DBL_MAX;
+            long long size = len_x*len_y;
+            bool accept = false;
+
+            if (!solution_found) {
+                if (len_x <= outline.width && len_y <= outline.height) {
+                    accept = true;
+                    solution_found = true;
+                    cost = design->costFunction(len_x, len_y);
+                } else if (len_x <= outline.width) {
+                    accept = len_y <= best_y;
+                } else if (len_y <= outline.height) {
+                    accept = len_x <= best_x;
+                } else {
+                    accept = size < best_size;
+                }
+            } else {
+                cost = design->costFunction(len_x, len_y);
+                accept = cost < best_cost && len_x <= outline.width && len_y <= outline.height;
+            }
+
+            if (!accept) {
+                double prob = solution_found ? exp((best_cost - cost) / temp) : exp((best_size - size) / temp);
+                if (batch.uniform(rng) < prob) {
+                    accept = true;
+                    if (len_x > outline.width || len_y > outline.height) {
+                        solution_found = false;
+                    }
+                } else {
+                    undoMove(move);
+                }
+            }
+
+            if (accept) {
+                best_cost = cost;
+                best_size = size;
+                best_x = len_x;
+                best_y = len_y;
+                if ((cost < overall_best_cost || !overall_solution_found) && best_x <= outline.width && best_y <= outline.height) {
+                    overall_solution_found = true;
+                    overall_best_cost = cost;
+                    snapshotBest();
+                    if (anytime != nullptr) {
+                        anytime->offer(this, cost);
+                    }
+                    finish_count = 0;
+                }
+            }
+        }
+
+        if (temp < 1e1) {
+            temp = reforge_temp;
+            for (int k = 0; k < num_blocks; k++) {
+                applyMove(randomMove());
+            }
+            if (overall_solution_found) {
+                if (finish_count == 40) {
+                    break;
+                }
+                if (finish_count % 3 == 0) {
+                    revertToBest();
+                }
+                finish_count += 1;
+            }
+        }
+
+        if (anytime != nullptr) {
+            anytime->poll(this);
+        }
+        if (stopRequested()) {
+            break;
+        }
+        if (max_iterations > 0) {
+            if (i >= max_iterations) {
+                break;
+            }
+        } else {
+            double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+            if (elapsed > runtime) {
+                break;
+            }
+        }
+
+        temp *= rate;
+    }
+
+    if (overall_solution_found) {
+        revertToBest();
+    }
+    return overall_solution_found ? overall_best_cost : DBL_MAX;
+}
+
+void BStarTree::copySolution(FloorplanEngine* other) {
+    BStarTree* source = static_cast<BStarTree*>(other);
+    tree = source->tree;
+    for (int i = 0; i < num_blocks; i++) {
+        if (blocks[i]->isRotated() != source->blocks[i]->isRotated()) {
+            blocks[i]->rotate90();
+        }
+    }
+}
+
+void BStarTree::outputDump(std::string filename, double runtime) {
+    long long len_x, len_y;
+    std::tie(len_x, len_y) = pack();
+    design->writeReport(filename, runtime, len_x, len_y);
+}
+
+void BStarTree::writeSnapshot(std::string filename, double runtime) {
+    long long len_x, len_y;
+    std::tie(len_x, len_y) = pack();
+    design->writeReport(filename, runtime, len_x, len_y, false);
+}
+
+void BStarTree::writeBestSnapshot(std::string filename, double runtime) {
+    std::vector<int> flipped;
+    for (int i = 0; i < num_blocks; i++) {
+        if (blocks[i]->isRotated() != (bool)best_rotated[i]) {
+            blocks[i]->rotate90();
+            flipped.push_back(i);
+        }
+    }
+    std::swap(tree, best_tree);
+    writeSnapshot(filename, runtime);
+    std::swap(tree, best_tree);
+    for (int i : flipped) {
+        blocks[i]->rotate90();
+    }
+}
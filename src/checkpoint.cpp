@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "checkpoint.h"
+
+static const char CHECKPOINT_MAGIC[4] = {'F', 'S', 'P', 'C'};
+static const uint32_t CHECKPOINT_VERSION = 3;
+
+bool saveCheckpoint(std::string filename, std::vector<FastSP*>& replicas, const Checkpoint& ckpt) {
+    // Write to a temporary file first, so a kill during the write
+    // never leaves a truncated checkpoint behind
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream file(tmp_filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open checkpoint file " << tmp_filename << std::endl;
+        return false;
+    }
+
+    int32_t num_replicas = replicas.size();
+    int32_t num_blocks = replicas[0]->getNumBlocks();
+    int32_t next_round = ckpt.next_round;
+    int32_t best_index = ckpt.best_index;
+    file.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    file.write(reinterpret_cast<const char*>(&CHECKPOINT_VERSION), sizeof(CHECKPOINT_VERSION));
+    uint32_t rng_engine = RNG_ENGINE_ID;
+    file.write(reinterpret_cast<const char*>(&rng_engine), sizeof(rng_engine));
+    file.write(reinterpret_cast<const char*>(&num_replicas), sizeof(num_replicas));
+    file.write(reinterpret_cast<const char*>(&num_blocks), sizeof(num_blocks));
+    file.write(reinterpret_cast<const char*>(&next_round), sizeof(next_round));
+    file.write(reinterpret_cast<const char*>(&best_index), sizeof(best_index));
+    for (int i = 0; i < num_replicas; i++) {
+        double cost = ckpt.costs[i];
+        std::ostringstream state;
+        replicas[i]->saveState(state);
+        std::string state_str = state.str();
+        uint32_t state_len = state_str.size();
+        file.write(reinterpret_cast<const char*>(&cost), sizeof(cost));
+        file.write(reinterpret_cast<const char*>(&state_len), sizeof(state_len));
+        file.write(state_str.data(), state_len);
+    }
+    file.close();
+    if (!file) {
+        std::cerr << "Error: Failed to write checkpoint file " << tmp_filename << std::endl;
+        return false;
+    }
+
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Error: Unable to replace checkpoint file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool loadCheckpoint(std::string filename, std::vector<FastSP*>& replicas, Checkpoint& ckpt) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open checkpoint file " << filename << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t rng_engine = 0;
+    int32_t num_replicas = 0;
+    int32_t num_blocks = 0;
+    int32_t next_round = 0;
+    int32_t best_index = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (file && version == CHECKPOINT_VERSION) {
+        file.read(reinterpret_cast<char*>(&rng_engine), sizeof(rng_engine));
+    }
+    file.read(reinterpret_cast<char*>(&num_replicas), sizeof(num_replicas));
+    file.read(reinterpret_cast<char*>(&num_blocks), sizeof(num_blocks));
+    file.read(reinterpret_cast<char*>(&next_round), sizeof(next_round));
+    file.read(reinterpret_cast<char*>(&best_index), sizeof(best_index));
+    if (!file || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "Error: Invalid checkpoint file " << filename << std::endl;
+        return false;
+    }
+    if (version != CHECKPOINT_VERSION) {
+        std::cerr << "Error: Unsupported checkpoint version " << version << std::endl;
+        return false;
+    }
+    if (rng_engine != RNG_ENGINE_ID) {
+        std::cerr << "Error: Checkpoint was written by a build with another RNG engine (FASTSP_RNG_MT19937)" << std::endl;
+        return false;
+    }
+    if (num_blocks != replicas[0]->getNumBlocks()) {
+        std::cerr << "Error: Checkpoint has " << num_blocks << " blocks, design has "
+                  << replicas[0]->getNumBlocks() << std::endl;
+        return false;
+    }
+    if (num_replicas != (int32_t)replicas.size()) {
+        std::cerr << "Error: Checkpoint has " << num_replicas << " replicas, but running with "
+                  << replicas.size() << " threads. Set OMP_NUM_THREADS=" << num_replicas << std::endl;
+        return false;
+    }
+
+    ckpt.next_round = next_round;
+    ckpt.best_index = best_index;
+    ckpt.costs.assign(num_replicas, 0.0);
+    ckpt.states.assign(num_replicas, std::string());
+    for (int i = 0; i < num_replicas; i++) {
+        uint32_t state_len = 0;
+        file.read(reinterpret_cast<char*>(&ckpt.costs[i]), sizeof(double));
+        file.read(reinterpret_cast<char*>(&state_len), sizeof(state_len));
+        // Bounded by the rest of the file before anything is allocated
+        std::streampos here = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streamoff remaining = file.tellg() - here;
+        file.seekg(here);
+        if (file && state_len <= remaining) {
+            ckpt.states[i].resize(state_len);
+            file.read(&ckpt.states[i][0], state_len);
+        } else {
+            file.setstate(std::ios::failbit);
+        }
+        if (!file) {
+            std::cerr << "Error: Corrupted replica " << i << " in checkpoint file " << filename << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool loadReplicaState(FastSP* replica, const std::string& state) {
+    std::istringstream in(state);
+    // The state must be read to its last byte
+    return replica->loadState(in) && in.peek() == std::char_traits<char>::eof();
+}
@@ -4,7 +4,14 @@
 #include <iostream>
 #include <sstream>
 #include <chrono>
+#include <cstring>
+#include <limits>
+#include <list>
 #include "fast_sp.h"
+#include "anytime.h"
+#include "pareto.h"
+
+std::atomic<uint64_t> FastSP::next_solution_tag(0);
 
 void FastSP::loadBlocks(std::string filename) {
     std::ifstream file(filename);
@@ -179,33 +186,135 @@ void FastSP::loadNets(std::string filename) {
     file.close();
 }
 
-double FastSP::runFastSP(double runtime) {
+//================================================================
+// In-memory design construction, an alternative to the loaders
+//================================================================
+void FastSP::addBlock(std::string name, int w, int h) {
+    Block* block = new Block(w, h, name);
+    blocks.push_back(block);
+    blockMap[name] = block;
+    num_blocks = blocks.size();
+}
+
+void FastSP::addTerminal(std::string name, int x, int y) {
+    Terminal* terminal = new Terminal(x, y, name);
+    terminals.push_back(terminal);
+    terminalMap[name] = terminal;
+    num_terminals = terminals.size();
+}
+
+void FastSP::addNet(const std::vector<std::string>& pins) {
+    Net* net = new Net();
+    for (auto& name : pins) {
+        auto block = blockMap.find(name);
+        auto terminal = terminalMap.find(name);
+        if (block != blockMap.end()) {
+            net->blocks.push_back(block->second);
+        } else if (terminal != terminalMap.end()) {
+            net->terminals.push_back(terminal->second);
+        } else {
+            std::cerr << "Warning: Terminal " << name << " not found! Skipped." << std::endl;
+        }
+    }
+    nets.push_back(net);
+    num_nets = nets.size();
+}
+
+// Pins by index into the blocks and terminals added so far
+void FastSP::addNet(const std::vector<int>& block_ids, const std::vector<int>& terminal_ids) {
+    Net* net = new Net();
+    for (int id : block_ids) {
+        net->blocks.push_back(blocks[id]);
+    }
+    for (int id : terminal_ids) {
+        net->terminals.push_back(terminals[id]);
+    }
+    nets.push_back(net);
+    num_nets = nets.size();
+}
+
+//================================================================
+// runFastSP
+//================================================================
+// - runtime: Wall-clock budget in seconds
+// - max_iterations: If > 0, stop after this many temperature steps
+//   instead of checking the clock, so seeded runs are reproducible
+//================================================================
+template <class T, class P>
+double FastSP::anneal(double runtime, long long max_iterations) {
+    typedef typename T::Coord Coord;
+    typedef typename T::Area Area;
+
     // int init_x, init_y;
     // std::tie(init_x, init_y) = initialize();
     // int best_x = init_x;
     // int best_y = init_y;
-    int best_x = evalSequencePair(false);
-    int best_y = evalSequencePair(true);
-    double best_cost = costFunction(best_x, best_y);
+    Coord best_x = evalSequencePairAs<Coord>(false);
+    Coord best_y = evalSequencePairAs<Coord>(true);
+    double best_cost = costAs<T, P>(best_x, best_y);
     double overall_best_cost = best_cost;
 
-    double temp = 10000.0;
+    double temp = init_temp;
     double reforge_temp = 1800.0+num_blocks*10;
+    if (warm_started) {
+        reforge_temp = std::min(reforge_temp, init_temp);
+    }
     double rate = 0.9999;
     int step_per_temp = 10;
     // int max_iter = 100000;
-    int best_size = best_x*best_y;
+    Area best_size = (Area)best_x*best_y;
     bool solution_found = best_x <= outline.width && best_y <= outline.height;
     bool overall_solution_found = solution_found;
-    SequencePair best_sp;
-    best_sp.x = sp.x;
-    best_sp.y = sp.y;
-    std::vector<bool> best_sp_rotated_blocks(num_blocks, false);
-    for (int i = 0; i < num_blocks; i++) {
-        best_sp_rotated_blocks[i] = blocks[i]->isRotated();
-    }
+    snapshotBest();
+
+    // Cost is only needed once a legal solution is known, or for the
+    // first legal one
+    auto moveCost = [&](Coord len_x, Coord len_y) {
+        if (solution_found || (len_x <= outline.width && len_y <= outline.height)) {
+            return costAs<T, P>(len_x, len_y);
+        }
+        return DBL_MAX;
+    };
+
+    // Acceptance of a move from the current state, see the phases below
+    auto metropolis = [&](Coord len_x, Coord len_y, double cost) {
+        Area size = (Area)len_x*len_y;
+        bool accept = false;
+        if (!solution_found) {
+            if (len_x <= outline.width && len_y <= outline.height) {
+                accept = true;
+                solution_found = true;
+            } else if (len_x <= outline.width) {
+                accept = len_y <= best_y;
+            } else if (len_y <= outline.height) {
+                accept = len_x <= best_x;
+            } else {
+                accept = size < best_size;
+            }
+        } else {
+            // Only calculate cost when solution is found
+            accept = cost < best_cost && len_x <= outline.width && len_y <= outline.height;
+        }
+
+        if (!accept) {
+            double prob;
+            if (solution_found) {
+                prob = exp((best_cost - cost) / temp);
+            } else {
+                prob = exp((best_size - size) / temp);
+            }
+            if (batch.uniform(rng) < prob) {
+                accept = true;
+                if (len_x > outline.width || len_y > outline.height) {
+                    solution_found = false;
+                }
+            }
+        }
+        return accept;
+    };
 
     int random_depth = 1;
+    batch.reset(num_blocks);
     auto start = std::chrono::high_resolution_clock::now();
     // Simulated annealing
     // 1. No solution found, both x and y are larger than the outline
@@ -221,64 +330,22 @@ double FastSP::runFastSP(double runtime) {
     while (1) {
         i++;
         for (int j = 0; j < step_per_temp; j++) {
-            std::vector<LastMove> last_moves = randomAction(random_depth);
-            int len_x = evalSequencePair(false);
-            int len_y = evalSequencePair(true);
-            double cost = DBL_MAX;
-            int size = len_x*len_y;
-            bool accept = false;
-            bool accept_uphill = false;
-
-            if (!solution_found) {
-                if (len_x <= outline.width && len_y <= outline.height) {
-                    accept = true;
-                    solution_found = true;
-                    cost = costFunction(len_x, len_y);
-                } else if (len_x <= outline.width) {
-                    if (len_y <= best_y) {
-                        accept = true;
-                    }
-                } else if (len_y <= outline.height) {
-                    if (len_x <= best_x) {
-                        accept = true;
-                    }
-                } else {
-                    if (size < best_size) {
-                        accept = true;
-                    }
-                }
-            } else {
-                // Only calculate cost when solution is found
-                cost = costFunction(len_x, len_y);
-                if (cost < best_cost) {
-                    accept = true;
-                }
-
-                if (len_x > outline.width || len_y > outline.height) {
-                    accept = false;
-                }
-            }
-
+            MoveList last_moves = randomAction(random_depth);
+            Coord len_x = evalSequencePairAs<Coord>(false);
+            Coord len_y = evalSequencePairAs<Coord>(true);
+            double cost = moveCost(len_x, len_y);
+            long long wirelength = last_wirelength;
+            evaluated_moves++;
+            bool accept = metropolis(len_x, len_y, cost);
             if (!accept) {
-                double prob;
-                if (solution_found) {
-                    prob = exp((best_cost - cost) / temp);
-                } else {
-                    prob = exp((best_size - size) / temp);
-                }
-                std::uniform_real_distribution<double> dist(0.0, 1.0);
-                if (dist(rng) < prob) {
-                    accept_uphill = true;
-                    if (len_x > outline.width || len_y > outline.height) {
-                        solution_found = false;
-                    }
-                } else {
-                    accept_uphill = false;
-                    undoAction(last_moves);
-                }
+                undoAction(last_moves);
             }
+            Area size = (Area)len_x*len_y;
 
-            if (accept || accept_uphill) {
+            if (accept) {
+                for (int k = 0; k < last_moves.size; k++) {
+                    journalMove(last_moves.moves[k]);
+                }
                 best_cost = cost;
                 best_size = size;
                 best_x = len_x;
@@ -286,13 +353,17 @@ double FastSP::runFastSP(double runtime) {
                 if ((cost < overall_best_cost || (!overall_solution_found)) && best_x <= outline.width && best_y <= outline.height) {
                     overall_solution_found = true;
                     overall_best_cost = cost;
-                    best_sp = sp;
-                    for (int i = 0; i < num_blocks; i++) {
-                        best_sp_rotated_blocks[i] = blocks[i]->isRotated();
+                    commitBest();
+                    newSolutionTag();
+                    if (anytime != nullptr) {
+                        anytime->offer(this, cost);
                     }
                     freezed_count = 0;
                     finish_count = 0;
                 }
+                if (archive != nullptr && best_x <= outline.width && best_y <= outline.height) {
+                    archive->offer(this, best_x, best_y, wirelength);
+                }
             } else {
                 freezed_count++;
             }
@@ -314,77 +385,191 @@ double FastSP::runFastSP(double runtime) {
             // std::cout << "==========" << std::endl;
             // std::cout << "Reforge!" << std::endl;
             // std::cout << "==========" << std::endl;
-            randomAction(num_blocks);
+            perturb(num_blocks);
             if (overall_solution_found) {                
                 if (finish_count == 40) {
                     break;
                 }
                 if (finish_count % 3 == 0) {
                     // Revert to the best solution
-                    sp = best_sp;
-                    for (int i = 0; i < num_blocks; i++) {
-                        if (blocks[i]->isRotated() != best_sp_rotated_blocks[i]) {
-                            blocks[i]->rotate90();
-                        }
-                    }
+                    revertToBest();
                 }
                 finish_count += 1;
                 freezed_count = 0;
             }
         };
 
-        double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
-        if (elapsed > runtime) {
+        if (anytime != nullptr) {
+            anytime->poll(this);
+        }
+        if (stopRequested()) {
             break;
         }
+        if (max_iterations > 0) {
+            if (i >= max_iterations) {
+                break;
+            }
+        } else {
+            double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+            if (elapsed > runtime) {
+                break;
+            }
+        }
 
         temp *= rate;
     }
 
-    sp = best_sp;
-    for (int i = 0; i < num_blocks; i++) {
-        if (blocks[i]->isRotated() != best_sp_rotated_blocks[i]) {
-            blocks[i]->rotate90();
-        }
+    // Without a legal solution keep the annealed state, it is closer
+    // to the outline than the starting point. It is a new solution, so
+    // replicas that copied the starting one must not skip copying it.
+    if (overall_solution_found) {
+        revertToBest();
+    } else {
+        newSolutionTag();
     }
     return overall_solution_found ? overall_best_cost : DBL_MAX;
 }
 
-std::pair<int, int> FastSP::initialize() {
+template <class T>
+double FastSP::annealWith(double runtime, long long max_iterations) {
+    switch (cost_model) {
+    case COST_AREA:
+        return anneal<T, AreaCost>(runtime, max_iterations);
+    case COST_WIRE:
+        return anneal<T, WireCost>(runtime, max_iterations);
+    default:
+        return anneal<T, MixedCost>(runtime, max_iterations);
+    }
+}
+
+double FastSP::runFastSP(double runtime, long long max_iterations) {
+    switch (cost_width) {
+    case COST_WIDTH_64:
+        return annealWith<Cost64>(runtime, max_iterations);
+    case COST_WIDTH_MIXED:
+        return annealWith<CostMixed>(runtime, max_iterations);
+    default:
+        return annealWith<Cost32>(runtime, max_iterations);
+    }
+}
+
+//================================================================
+// Replica state layout
+//================================================================
+// Everything the move loop reads or writes besides the blocks and the
+// host tree lives in one aligned arena, in the order it is touched:
+// X, Y, MATCH and BUCKL of evalSequencePair, the journal and the best
+// snapshot. Sequences, MATCH and the journal hold 16-bit indices while
+// num_blocks < 65536, rotations of the snapshot one bit per block. For
+// 4000 blocks this is about 110 KB per replica, down from 190 KB spread
+// over fourteen heap vectors.
+//================================================================
+void FastSP::layoutState() {
+    int n = num_blocks + 1;
+    bool narrow = IndexArray::fitsNarrow(num_blocks);
+    size_t index_bytes = IndexArray::bytesFor(n, narrow);
+    state.reset(8 * index_bytes + StateArena::bytesFor<int64_t>(n) +
+                3 * StateArena::bytesFor<char>(n) + BitArray::bytesFor(n));
+    sp.x.bind(state, n, narrow);
+    sp.y.bind(state, n, narrow);
+    eval_match.bind(state, n, narrow);
+    eval_buckl = state.carve<int64_t>(n);
+    journal.x.bind(state, n, narrow);
+    journal.y.bind(state, n, narrow);
+    journal.rot.bind(state, n, narrow);
+    journal.dirty_x = state.carve<char>(n);
+    journal.dirty_y = state.carve<char>(n);
+    journal.dirty_rot = state.carve<char>(n);
+    journal.num_x = 0;
+    journal.num_y = 0;
+    journal.num_rot = 0;
+    best_sp.x.bind(state, n, narrow);
+    best_sp.y.bind(state, n, narrow);
+    best_rotated.bind(state, n);
+}
+
+void FastSP::resetSequencePair() {
     // Initialize pos_x and pos_y
     pos_x = std::vector<int>(num_blocks+1, 0);
     pos_y = std::vector<int>(num_blocks+1, 0);
 
     // Initialize sequence pair
-    sp.x = std::vector<int>(num_blocks+1, 0);
-    sp.y = std::vector<int>(num_blocks+1, 0);
+    layoutState();
     for (int i = 1; i < num_blocks+1; i++) {
-        sp.x[i] = i;
-        sp.y[i] = i;
+        sp.x.set(i, i);
+        sp.y.set(i, i);
     }
+    newSolutionTag();
+}
+
+SequencePair FastSP::getSequencePair() {
+    SequencePair s;
+    s.x.resize(sp.x.size());
+    s.y.resize(sp.y.size());
+    for (int i = 0; i < sp.x.size(); i++) {
+        s.x[i] = sp.x[i];
+        s.y[i] = sp.y[i];
+    }
+    return s;
+}
+
+// Sizes other than num_blocks+1 are ignored
+void FastSP::setSequencePair(const SequencePair& s) {
+    if (sp.x.size() != num_blocks+1) {
+        layoutState();
+    }
+    if ((int)s.x.size() != num_blocks+1 || (int)s.y.size() != num_blocks+1) {
+        return;
+    }
+    for (int i = 1; i < num_blocks+1; i++) {
+        sp.x.set(i, s.x[i]);
+        sp.y.set(i, s.y[i]);
+    }
+}
 
+void FastSP::initRng() {
     // Initialize random number generator
-    std::random_device rd;
-    seed = rd();
-    rng = std::mt19937(seed);
+    // Only draw from the random device when no seed was given
+    if (!seeded) {
+        std::random_device rd;
+        seed = rd();
+    }
+    rng = RngEngine(seed);
+}
+
+// Take over a sequence pair and the rotation of every block (indexed
+// from 0), e.g. projected from a coarser level
+void FastSP::setSolution(const SequencePair& s, const std::vector<char>& rotated) {
+    resetSequencePair();
+    setSequencePair(s);
+    for (int i = 0; i < num_blocks; i++) {
+        if (blocks[i]->isRotated() != (bool)rotated[i]) {
+            blocks[i]->rotate90();
+        }
+    }
+}
+
+std::pair<long long, long long> FastSP::initialize() {
+    resetSequencePair();
+    initRng();
 
     // Randomly shuffle the sequence pair
     // Pick the best one out of 1000 random shuffles
     double best_cost = 1e9;
-    int best_x = 0;
-    int best_y = 0;
+    long long best_x = 0;
+    long long best_y = 0;
     SequencePair best_sp;
     for (int i = 0; i < 4000; i++) {
-        std::shuffle(sp.x.begin()+1, sp.x.end(), rng);
-        std::shuffle(sp.y.begin()+1, sp.y.end(), rng);
-        int len_x = evalSequencePair(false);
-        int len_y = evalSequencePair(true);
+        sp.x.shuffle(1, num_blocks+1, rng);
+        sp.y.shuffle(1, num_blocks+1, rng);
+        long long len_x = evalSequencePair(false);
+        long long len_y = evalSequencePair(true);
         double cost = costFunction(len_x, len_y);
         if (cost < best_cost) {
             best_cost = cost;
             best_x = len_x;
             best_y = len_y;
-            best_sp = sp;
+            best_sp = getSequencePair();
         }
     }
     // std::cout << "Initialization done!" << std::endl;
@@ -392,65 +577,676 @@ std::pair<int, int> FastSP::initialize() {
     // std::cout << "Best size: " << best_size << std::endl;
     // std::cout << "Best X: " << best_x << std::endl;
     // std::cout << "Best Y: " << best_y << std::endl;
-    sp = best_sp;
+    setSequencePair(best_sp);
     return std::make_pair(best_x, best_y);
 }
 
-std::vector<LastMove> FastSP::randomAction(int depth) {
-    std::uniform_int_distribution<int> index_dist(1, num_blocks);
-    std::uniform_int_distribution<int> action_dist(0, 3);
-    std::vector<LastMove> last_moves(depth);
-    for (int i = 0; i < depth; i++) {
-        int j = index_dist(rng);
-        int k = index_dist(rng);
-        int action = action_dist(rng);
-        if (action == 0) {
-            swapSingle(false, j, k);
-        } else if (action == 1) {
-            swapSingle(true, j, k);
-        } else if (action == 2) {
-            swapBoth(j, k);
-        } else {
-            rotate90(j);
+//================================================================
+// Constructive shelf initializer
+//================================================================
+// Blocks are laid flat and packed left to right into rows (shelves)
+// of at most `row_width`, tallest first. Among the next few blocks
+// of similar height, the one most connected to the current and the
+// previous row is taken, so connected blocks end up close. Rows map
+// to the sequence pair as:
+// - X: rows from top to bottom, each row from left to right
+// - Y: rows from bottom to top, each row from left to right
+// Row widths up to the outline width are tried with blocks laid flat
+// and standing; the cheapest legal (or else the least oversized)
+// packing is kept.
+//================================================================
+std::pair<long long, long long> FastSP::initializeShelf() {
+    resetSequencePair();
+    initRng();
+
+    // Connectivity between blocks, each net contributes 1/(degree-1)
+    // Very large nets carry little placement information, skip them
+    std::unordered_map<Block*, int> index_of;
+    for (int i = 0; i < num_blocks; i++) {
+        index_of[blocks[i]] = i + 1;
+    }
+    std::vector<std::unordered_map<int, double>> conn(num_blocks+1);
+    for (auto net : nets) {
+        int degree = net->blocks.size();
+        if (degree < 2 || degree > 64) {
+            continue;
+        }
+        double w = 1.0 / (degree - 1);
+        for (int a = 0; a < degree; a++) {
+            for (int b = a + 1; b < degree; b++) {
+                int ia = index_of[net->blocks[a]];
+                int ib = index_of[net->blocks[b]];
+                conn[ia][ib] += w;
+                conn[ib][ia] += w;
+            }
+        }
+    }
+
+    const int lookahead = 4;
+    double best_cost = DBL_MAX;
+    bool best_legal = false;
+    long long best_x = 0;
+    long long best_y = 0;
+    SequencePair best_sp = getSequencePair();
+    std::vector<bool> best_rotated(num_blocks, false);
+    std::vector<int> order(num_blocks);
+    for (int i = 0; i < num_blocks; i++) {
+        order[i] = i + 1;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    for (int attempt = 0; attempt < 10; attempt++) {
+        // Lay blocks flat (or stand them up in the second half of the
+        // attempts) unless they would not fit into the outline width
+        bool want_flat = attempt < 5;
+        for (int i = 0; i < num_blocks; i++) {
+            Block* block = blocks[i];
+            bool flat = block->getHeight() <= block->getWidth();
+            bool fits = std::max(block->getWidth(), block->getHeight()) <= outline.width;
+            if (flat != (want_flat && fits)) {
+                block->rotate90();
+            }
+        }
+
+        // Tallest first, random tie-break so replicas start differently
+        std::vector<int> by_height = order;
+        std::stable_sort(by_height.begin(), by_height.end(), [&](int a, int b) {
+            return blocks[a-1]->getHeight() > blocks[b-1]->getHeight();
+        });
+
+        int row_width = outline.width * (1.0 - 0.05 * (attempt % 5));
+
+        std::vector<std::vector<int>> rows(1);
+        std::vector<bool> in_prev_row(num_blocks+1, false);
+        std::vector<bool> in_row(num_blocks+1, false);
+        std::list<int> remaining(by_height.begin(), by_height.end());
+        int x = 0;
+        while (!remaining.empty()) {
+            // Pick the most connected block among the next few candidates
+            // that still fit into the current row
+            auto pick = remaining.end();
+            double pick_conn = -1.0;
+            int k = 0;
+            for (auto it = remaining.begin(); it != remaining.end() && k < lookahead; it++) {
+                if (x + blocks[*it-1]->getWidth() > row_width) {
+                    continue;
+                }
+                k++;
+                double c = 0.0;
+                for (auto& e : conn[*it]) {
+                    if (in_row[e.first] || in_prev_row[e.first]) {
+                        c += e.second;
+                    }
+                }
+                if (c > pick_conn) {
+                    pick_conn = c;
+                    pick = it;
+                }
+            }
+            // Nothing fits, open a new row with the tallest remaining block
+            if (pick == remaining.end()) {
+                pick = remaining.begin();
+            }
+            int b = *pick;
+            remaining.erase(pick);
+
+            int w = blocks[b-1]->getWidth();
+            if (x + w > row_width && !rows.back().empty()) {
+                for (int id : rows.back()) {
+                    in_prev_row[id] = true;
+                }
+                if (rows.size() >= 2) {
+                    for (int id : rows[rows.size()-2]) {
+                        in_prev_row[id] = false;
+                    }
+                }
+                std::fill(in_row.begin(), in_row.end(), false);
+                rows.emplace_back();
+                x = 0;
+            }
+            rows.back().push_back(b);
+            in_row[b] = true;
+            x += w;
+        }
+
+        int k = 1;
+        for (int r = rows.size() - 1; r >= 0; r--) {
+            for (int id : rows[r]) {
+                sp.x.set(k++, id);
+            }
+        }
+        k = 1;
+        for (size_t r = 0; r < rows.size(); r++) {
+            for (int id : rows[r]) {
+                sp.y.set(k++, id);
+            }
+        }
+
+        // Rank legal packings by cost, the others by how far they
+        // exceed the outline
+        long long len_x = evalSequencePair(false);
+        long long len_y = evalSequencePair(true);
+        bool legal = len_x <= outline.width && len_y <= outline.height;
+        double cost = legal ? costFunction(len_x, len_y)
+                            : std::max((double)len_x / outline.width, (double)len_y / outline.height);
+        if ((legal && !best_legal) || (legal == best_legal && cost < best_cost)) {
+            best_legal = legal;
+            best_cost = cost;
+            best_x = len_x;
+            best_y = len_y;
+            best_sp = getSequencePair();
+            for (int i = 0; i < num_blocks; i++) {
+                best_rotated[i] = blocks[i]->isRotated();
+            }
+        }
+    }
+    setSequencePair(best_sp);
+    for (int i = 0; i < num_blocks; i++) {
+        if (blocks[i]->isRotated() != best_rotated[i]) {
+            blocks[i]->rotate90();
+        }
+    }
+    return std::make_pair(best_x, best_y);
+}
+
+//================================================================
+// Warm start from a previous report
+//================================================================
+// A block a placed left of b must come before b in both X and Y,
+// a block a below b comes after b in X and before b in Y. Diagonal
+// pairs fit both relations, so they only constrain one sequence:
+// - X: a before b if a is left of or above b, unless a is lower-left
+// - Y: a before b if a is left of or below b, unless a is upper-left
+// Any topological order of these forced relations reproduces a
+// packing no larger than the report. Ties are broken by the diagonal
+// (x-y for X, x+y for Y). Blocks not in the report are appended,
+// i.e. placed to the upper right.
+// The report is read once by `readWarmStart`, so its errors and
+// warnings print once however many replicas start from it.
+//================================================================
+bool FastSP::warmStart(std::string filename) {
+    std::vector<WarmPlacement> placed;
+    if (!readWarmStart(filename, placed)) {
+        return false;
+    }
+    warmStart(placed);
+    return true;
+}
+
+bool FastSP::readWarmStart(std::string filename, std::vector<WarmPlacement>& placed) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open report file " << filename << std::endl;
+        return false;
+    }
+
+    // Skip cost, wirelength, area, bounding box and runtime
+    std::string line;
+    for (int i = 0; i < 5; i++) {
+        if (!std::getline(file, line)) {
+            std::cerr << "Error: Invalid report file format. Expected header!" << std::endl;
+            return false;
+        }
+    }
+
+    std::unordered_map<Block*, int> index_of;
+    for (int i = 0; i < num_blocks; i++) {
+        index_of[blocks[i]] = i + 1;
+    }
+
+    placed.clear();
+    std::vector<bool> is_placed(num_blocks+1, false);
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string name;
+        long long x1, y1, x2, y2;
+        if (!(iss >> name >> x1 >> y1 >> x2 >> y2)) {
+            continue;
         }
-        last_moves[i] = {j, k, action};
+        auto it = blockMap.find(name);
+        if (it == blockMap.end()) {
+            std::cerr << "Warning: Block " << name << " not found! Skipped." << std::endl;
+            continue;
+        }
+        int id = index_of[it->second];
+        if (is_placed[id]) {
+            continue;
+        }
+        is_placed[id] = true;
+        placed.push_back({id, x1, y1, x2, y2});
+    }
+    file.close();
+    return true;
+}
+
+void FastSP::warmStart(const std::vector<WarmPlacement>& placed) {
+    // Keep the orientation of the previous floorplan, even if the
+    // block changed size since then
+    std::vector<bool> is_placed(num_blocks+1, false);
+    for (const WarmPlacement& p : placed) {
+        is_placed[p.id] = true;
+        Block* block = blocks[p.id-1];
+        bool was_wide = (p.x2 - p.x1) > (p.y2 - p.y1);
+        bool is_wide = block->getWidth() > block->getHeight();
+        if (block->getWidth() != block->getHeight() && was_wide != is_wide) {
+            block->rotate90();
+        }
+    }
+
+    int m = placed.size();
+    std::vector<std::vector<int>> succ_x(m), succ_y(m);
+    std::vector<int> indeg_x(m, 0), indeg_y(m, 0);
+    auto addEdge = [](std::vector<std::vector<int>>& succ, std::vector<int>& indeg, int from, int to) {
+        succ[from].push_back(to);
+        indeg[to]++;
+    };
+    for (int a = 0; a < m; a++) {
+        for (int b = a + 1; b < m; b++) {
+            const WarmPlacement& pa = placed[a];
+            const WarmPlacement& pb = placed[b];
+            bool a_left = pa.x2 <= pb.x1;
+            bool b_left = pb.x2 <= pa.x1;
+            bool a_above = pa.y1 >= pb.y2;
+            bool b_above = pb.y1 >= pa.y2;
+            if ((a_left && !b_above) || (a_above && !b_left)) {
+                addEdge(succ_x, indeg_x, a, b);
+            } else if ((b_left && !a_above) || (b_above && !a_left)) {
+                addEdge(succ_x, indeg_x, b, a);
+            }
+            if ((a_left && !a_above) || (b_above && !b_left)) {
+                addEdge(succ_y, indeg_y, a, b);
+            } else if ((b_left && !b_above) || (a_above && !a_left)) {
+                addEdge(succ_y, indeg_y, b, a);
+            }
+        }
+    }
+
+    // Kahn's algorithm, breaking ties (and cycles) by the smallest key
+    auto topoOrder = [&](std::vector<std::vector<int>>& succ, std::vector<int>& indeg, int sign) {
+        std::vector<long long> key(m);
+        for (int a = 0; a < m; a++) {
+            key[a] = (long long)placed[a].x1 + placed[a].x2 + sign * ((long long)placed[a].y1 + placed[a].y2);
+        }
+        std::vector<bool> done(m, false);
+        std::vector<int> order;
+        while ((int)order.size() < m) {
+            int pick = -1;
+            for (int a = 0; a < m; a++) {
+                if (!done[a] && indeg[a] == 0 && (pick == -1 || key[a] < key[pick])) {
+                    pick = a;
+                }
+            }
+            if (pick == -1) {
+                for (int a = 0; a < m; a++) {
+                    if (!done[a] && (pick == -1 || key[a] < key[pick])) {
+                        pick = a;
+                    }
+                }
+            }
+            done[pick] = true;
+            order.push_back(placed[pick].id);
+            for (int b : succ[pick]) {
+                indeg[b]--;
+            }
+        }
+        return order;
+    };
+    std::vector<int> order_x = topoOrder(succ_x, indeg_x, -1);
+    std::vector<int> order_y = topoOrder(succ_y, indeg_y, 1);
+
+    resetSequencePair();
+    initRng();
+    int k = 1;
+    for (int i = 0; i < m; i++, k++) {
+        sp.x.set(k, order_x[i]);
+        sp.y.set(k, order_y[i]);
+    }
+    for (int id = 1; id < num_blocks+1; id++) {
+        if (!is_placed[id]) {
+            sp.x.set(k, id);
+            sp.y.set(k, id);
+            k++;
+        }
+    }
+}
+
+MoveList FastSP::randomAction(int depth) {
+    MoveList last_moves;
+    last_moves.size = std::min(depth, (int)MoveList::CAPACITY);
+    for (int i = 0; i < last_moves.size; i++) {
+        int j = batch.index(rng);
+        int k = batch.index(rng);
+        int action = batch.action(rng);
+        last_moves.moves[i] = {j, k, action};
+        applyAction(last_moves.moves[i]);
     }
     return last_moves;
 }
 
+// Unrecorded random moves, used to shake up the solution on reheat
+void FastSP::perturb(int depth) {
+    for (int i = 0; i < depth; i++) {
+        int j = batch.index(rng);
+        int k = batch.index(rng);
+        int action = batch.action(rng);
+        LastMove move = {j, k, action};
+        applyAction(move);
+        journalMove(move);
+    }
+}
+
 void FastSP::swapSingle(bool do_y_or_x, int i, int j) {
     if (do_y_or_x) {
-        std::swap(sp.y[i], sp.y[j]);
+        sp.y.swap(i, j);
     } else {
-        std::swap(sp.x[i], sp.x[j]);
+        sp.x.swap(i, j);
     }
 }
 
 void FastSP::swapBoth(int i, int j) {
-    std::swap(sp.x[i], sp.x[j]);
-    std::swap(sp.y[i], sp.y[j]);
+    sp.x.swap(i, j);
+    sp.y.swap(i, j);
 }
 
 void FastSP::rotate90(int i) {
     blocks[i-1]->rotate90();
 }
 
-void FastSP::undoAction(std::vector<LastMove>& last_moves) {
+// Every action is its own inverse
+void FastSP::applyAction(const LastMove& move) {
+    if (move.action == 0) {
+        swapSingle(false, move.i, move.j);
+    } else if (move.action == 1) {
+        swapSingle(true, move.i, move.j);
+    } else if (move.action == 2) {
+        swapBoth(move.i, move.j);
+    } else {
+        rotate90(move.i);
+    }
+}
+
+void FastSP::undoAction(MoveList& last_moves) {
     // Reverse the last moves
-    for (int i = last_moves.size()-1; i >= 0; i--) {
-        int j = last_moves[i].i;
-        int k = last_moves[i].j;
-        int action = last_moves[i].action;
-        if (action == 0) {
-            swapSingle(false, j, k);
-        } else if (action == 1) {
-            swapSingle(true, j, k);
-        } else if (action == 2) {
-            swapBoth(j, k);
-        } else {
-            rotate90(j);
+    for (int i = last_moves.size-1; i >= 0; i--) {
+        applyAction(last_moves.moves[i]);
+    }
+}
+
+//================================================================
+// Best solution journal
+//================================================================
+// Instead of copying the whole sequence pair on every new best and
+// on every revert, only the entries touched by accepted moves since
+// the last snapshot are copied. Each entry is journaled at most once,
+// so both operations cost O(min(moves, n)).
+//================================================================
+void FastSP::journalMove(const LastMove& move) {
+    auto mark = [](IndexArray& entries, int& count, char* dirty, int i) {
+        if (!dirty[i]) {
+            dirty[i] = 1;
+            entries.set(count++, i);
+        }
+    };
+    if (move.action == 0 || move.action == 2) {
+        mark(journal.x, journal.num_x, journal.dirty_x, move.i);
+        mark(journal.x, journal.num_x, journal.dirty_x, move.j);
+    }
+    if (move.action == 1 || move.action == 2) {
+        mark(journal.y, journal.num_y, journal.dirty_y, move.i);
+        mark(journal.y, journal.num_y, journal.dirty_y, move.j);
+    }
+    if (move.action == 3) {
+        mark(journal.rot, journal.num_rot, journal.dirty_rot, move.i);
+    }
+}
+
+void FastSP::snapshotBest() {
+    best_sp.x.copyFrom(sp.x);
+    best_sp.y.copyFrom(sp.y);
+    for (int i = 1; i < num_blocks+1; i++) {
+        best_rotated.assign(i, blocks[i-1]->isRotated());
+    }
+    journal.num_x = 0;
+    journal.num_y = 0;
+    journal.num_rot = 0;
+    std::fill(journal.dirty_x, journal.dirty_x + num_blocks+1, 0);
+    std::fill(journal.dirty_y, journal.dirty_y + num_blocks+1, 0);
+    std::fill(journal.dirty_rot, journal.dirty_rot + num_blocks+1, 0);
+}
+
+void FastSP::commitBest() {
+    for (int k = 0; k < journal.num_x; k++) {
+        int i = journal.x[k];
+        best_sp.x.set(i, sp.x[i]);
+        journal.dirty_x[i] = 0;
+    }
+    for (int k = 0; k < journal.num_y; k++) {
+        int i = journal.y[k];
+        best_sp.y.set(i, sp.y[i]);
+        journal.dirty_y[i] = 0;
+    }
+    for (int k = 0; k < journal.num_rot; k++) {
+        int i = journal.rot[k];
+        best_rotated.assign(i, blocks[i-1]->isRotated());
+        journal.dirty_rot[i] = 0;
+    }
+    journal.num_x = 0;
+    journal.num_y = 0;
+    journal.num_rot = 0;
+}
+
+void FastSP::revertToBest() {
+    for (int k = 0; k < journal.num_x; k++) {
+        int i = journal.x[k];
+        sp.x.set(i, best_sp.x[i]);
+        journal.dirty_x[i] = 0;
+    }
+    for (int k = 0; k < journal.num_y; k++) {
+        int i = journal.y[k];
+        sp.y.set(i, best_sp.y[i]);
+        journal.dirty_y[i] = 0;
+    }
+    for (int k = 0; k < journal.num_rot; k++) {
+        int i = journal.rot[k];
+        if (blocks[i-1]->isRotated() != best_rotated.test(i)) {
+            blocks[i-1]->rotate90();
+        }
+        journal.dirty_rot[i] = 0;
+    }
+    journal.num_x = 0;
+    journal.num_y = 0;
+    journal.num_rot = 0;
+}
+
+//================================================================
+// Post-annealing compaction
+//================================================================
+// Greedy descent on the final solution. A move is kept only if the
+// packing stays inside the outline and the cost drops:
+// 1. Rotating a block on a critical chain
+// 2. Swapping a critical block with its neighbor in X or in Y
+// 3. Exchanging a critical block with a block it shares a net with,
+//    in both sequences
+// Critical blocks are visited by the HPWL of their nets, longest
+// first. Passes repeat until none improves or `max_placements` block
+// placements were spent, so the result only depends on the solution.
+// Every packing counts, those of the critical chain search included.
+// `time_limit` (seconds, 0 for none) is a safety net for unseeded runs
+// only.
+//================================================================
+// A block is on a critical chain if its left (bottom) chain plus its
+// right (top) chain spans the whole packing. Reversing both sequences
+// mirrors the packing, so the mirrored coordinates are the right (top)
+// chains. Leaves the coordinates of the current packing.
+std::vector<int> FastSP::criticalBlocks(long long len_x, long long len_y) {
+    std::vector<long long> x(num_blocks+1), y(num_blocks+1);
+    for (int b = 1; b < num_blocks+1; b++) {
+        x[b] = blocks[b-1]->getCoordX();
+        y[b] = blocks[b-1]->getCoordY();
+    }
+    sp.x.reverse(1, num_blocks+1);
+    sp.y.reverse(1, num_blocks+1);
+    evalSequencePair(false);
+    evalSequencePair(true);
+    sp.x.reverse(1, num_blocks+1);
+    sp.y.reverse(1, num_blocks+1);
+
+    std::vector<int> critical;
+    for (int b = 1; b < num_blocks+1; b++) {
+        Block* block = blocks[b-1];
+        if (x[b] + block->getWidth() + block->getCoordX() == len_x ||
+            y[b] + block->getHeight() + block->getCoordY() == len_y) {
+            critical.push_back(b);
+        }
+    }
+    evalSequencePair(false);
+    evalSequencePair(true);
+    return critical;
+}
+
+int FastSP::compact(long long max_placements, double time_limit) {
+    auto start = std::chrono::high_resolution_clock::now();
+    // A packing places every block once per sequence
+    long long pack_cost = 2LL * num_blocks;
+    long long placements = pack_cost;
+    auto expired = [&]() {
+        if (placements + pack_cost > max_placements) {
+            return true;
+        }
+        return time_limit > 0 && std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count() > time_limit;
+    };
+
+    long long len_x = evalSequencePair(false);
+    long long len_y = evalSequencePair(true);
+    if (len_x > outline.width || len_y > outline.height) {
+        return 0;
+    }
+    double cost = costFunction(len_x, len_y);
+
+    // Nets and net neighbors of every block, ignoring huge nets
+    std::unordered_map<Block*, int> block_index;
+    for (int b = 1; b < num_blocks+1; b++) {
+        block_index[blocks[b-1]] = b;
+    }
+    std::vector<std::vector<Net*>> block_nets(num_blocks+1);
+    std::vector<std::vector<int>> neighbors(num_blocks+1);
+    for (auto net : nets) {
+        for (auto block : net->blocks) {
+            block_nets[block_index[block]].push_back(net);
+        }
+        if (net->blocks.size() > 16) {
+            continue;
+        }
+        for (auto a : net->blocks) {
+            for (auto b : net->blocks) {
+                if (a != b) {
+                    neighbors[block_index[a]].push_back(block_index[b]);
+                }
+            }
         }
     }
+    for (auto& list : neighbors) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    std::vector<int> pos_x(num_blocks+1), pos_y(num_blocks+1);
+    auto updatePositions = [&]() {
+        for (int i = 1; i < num_blocks+1; i++) {
+            pos_x[sp.x[i]] = i;
+            pos_y[sp.y[i]] = i;
+        }
+    };
+
+    auto tryMoves = [&](MoveList& moves) {
+        if (placements + pack_cost > max_placements) {
+            return false;
+        }
+        placements += pack_cost;
+        for (int i = 0; i < moves.size; i++) {
+            applyAction(moves.moves[i]);
+        }
+        long long lx = evalSequencePair(false);
+        long long ly = evalSequencePair(true);
+        if (lx <= outline.width && ly <= outline.height) {
+            double c = costFunction(lx, ly);
+            if (c < cost) {
+                cost = c;
+                updatePositions();
+                return true;
+            }
+        }
+        undoAction(moves);
+        return false;
+    };
+
+    int accepted = 0;
+    bool improved = true;
+    while (improved && !expired()) {
+        improved = false;
+        len_x = evalSequencePair(false);
+        len_y = evalSequencePair(true);
+        std::vector<int> critical = criticalBlocks(len_x, len_y);
+        // The mirrored packing and the restored one
+        placements += 3 * pack_cost;
+        std::vector<long long> net_hpwl(num_blocks+1, 0);
+        for (int b : critical) {
+            for (auto net : block_nets[b]) {
+                net_hpwl[b] += netHPWL(net);
+            }
+        }
+        std::stable_sort(critical.begin(), critical.end(), [&](int a, int b) {
+            return net_hpwl[a] > net_hpwl[b];
+        });
+        updatePositions();
+
+        for (int b : critical) {
+            if (expired()) {
+                break;
+            }
+            MoveList moves;
+            moves.size = 1;
+            moves.moves[0] = {b, b, 3};
+            if (tryMoves(moves)) {
+                accepted++;
+                improved = true;
+            }
+            for (int d = -1; d <= 1; d += 2) {
+                int i = pos_x[b] + d;
+                if (i >= 1 && i <= num_blocks) {
+                    moves.moves[0] = {pos_x[b], i, 0};
+                    if (tryMoves(moves)) {
+                        accepted++;
+                        improved = true;
+                    }
+                }
+                int j = pos_y[b] + d;
+                if (j >= 1 && j <= num_blocks) {
+                    moves.moves[0] = {pos_y[b], j, 1};
+                    if (tryMoves(moves)) {
+                        accepted++;
+                        improved = true;
+                    }
+                }
+            }
+            moves.size = 2;
+            for (int c : neighbors[b]) {
+                moves.moves[0] = {pos_x[b], pos_x[c], 0};
+                moves.moves[1] = {pos_y[b], pos_y[c], 1};
+                if (tryMoves(moves)) {
+                    accepted++;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    evalSequencePair(false);
+    evalSequencePair(true);
+    if (accepted > 0) {
+        snapshotBest();
+        newSolutionTag();
+    }
+    return accepted;
 }
 
 //================================================================
@@ -481,41 +1277,74 @@ void FastSP::undoAction(std::vector<LastMove>& last_moves) {
 // - H: Host tree, implemented in FastBitSetTree
 // - BUCKL: Buckets for the host tree
 //   - BUCKL[p] records the length of the longest common subsequence.
-int FastSP::evalSequencePair(bool do_y_or_x) {
-    if (do_y_or_x) {
-        reverse(sp.x.begin()+1, sp.x.end());
+// The coordinate type and the host tree are template parameters,
+// evalSequencePair dispatches to the instantiation picked by
+// selectCostTypes and setHostTree. Hosts and buffers are members, so
+// evaluations do not allocate.
+long long FastSP::evalSequencePair(bool do_y_or_x) {
+    if (cost_width == COST_WIDTH_64) {
+        return evalSequencePairAs<int64_t>(do_y_or_x);
     }
+    return evalSequencePairAs<int32_t>(do_y_or_x);
+}
+
+template <class Coord>
+Coord FastSP::evalSequencePairAs(bool do_y_or_x) {
+    switch (host_kind) {
+    case HOST_HIER:
+        return evalSequencePairWith<Coord>(hier_host, do_y_or_x);
+    case HOST_FENWICK:
+        return evalSequencePairWith<Coord>(fenwick_host, do_y_or_x);
+    case HOST_VEB:
+        return evalSequencePairWith<Coord>(veb_host, do_y_or_x);
+    default:
+        return evalSequencePairWith<Coord>(flat_host, do_y_or_x);
+    }
+}
+
+template <class Coord, class HostTree>
+Coord FastSP::evalSequencePairWith(HostTree& host, bool do_y_or_x) {
+    if (sp.x.isNarrow()) {
+        return evalSequencePairKernel<Coord, uint16_t>(host, do_y_or_x);
+    }
+    return evalSequencePairKernel<Coord, int32_t>(host, do_y_or_x);
+}
+
+// X, Y and MATCH are read through pointers of their stored index type.
+// The Y coordinates come from the reversed X, which is read backwards
+// instead of reversed in place.
+template <class Coord, class Index, class HostTree>
+Coord FastSP::evalSequencePairKernel(HostTree& host, bool do_y_or_x) {
+    const Index* x = sp.x.data(Index());
+    const Index* y = sp.y.data(Index());
+    const Index* next = do_y_or_x ? x + num_blocks : x + 1;
+    const int step = do_y_or_x ? -1 : 1;
     // Initialize MATCH
     // Pad with 0 to make 1-indexed
     // 0 is the starting point `s`
-    std::vector<int> match(num_blocks+1);
+    Index* match = eval_match.data(Index());
     match[0] = 0;
     for (int i = 1; i < num_blocks+1; i++) {
-        // if (do_y_or_x) {
-        //     match[sp.x[i]] = i;
-        // } else {
-            match[sp.y[i]] = i;
-        // }
+        match[y[i]] = i;
     }
     // Initialize H
-    FastBitSetTree host(num_blocks+1);
+    host.reset(num_blocks+1);
     host.insert(0);
     // Initialize BUCKL with BUCKL[0] = 0
     // -1 means empty
-    std::vector<int> BUCKL(num_blocks+1, -1);
+    Coord* BUCKL = bucklBuffer(Coord());
+    std::fill(BUCKL, BUCKL + num_blocks+1, -1);
     BUCKL[0] = 0;
-    for (int i = 1; i < num_blocks+1; i++) {
-        int b = sp.x[i];
+    for (int i = 1; i < num_blocks+1; i++, next += step) {
+        int b = *next;
         int p = match[b];   // P is the position of b in Y
         host.insert(p);
         int pred = host.predecessor(p);
-        int pos = BUCKL[pred];
+        Coord pos = BUCKL[pred];
         if (do_y_or_x) {
-            // pos_y[p] = pos;
             BUCKL[p] = pos + blocks[b-1]->getHeight();
             blocks[b-1]->setCoordY(pos);
         } else {
-            // pos_x[p] = pos;
             BUCKL[p] = pos + blocks[b-1]->getWidth();
             blocks[b-1]->setCoordX(pos);
         }
@@ -529,27 +1358,56 @@ int FastSP::evalSequencePair(bool do_y_or_x) {
             }
         }
     }
-    if (do_y_or_x) {
-        reverse(sp.x.begin()+1, sp.x.end());
-    }
-    
+
     return BUCKL[host.maximum()];
 }
 
-int FastSP::netHPWL(Net* net) {
+// Time full packings of the current solution with every host tree for
+// `budget` seconds in total, keep the fastest. All hosts produce the
+// same packing, so the choice never changes the result.
+HostTreeKind FastSP::calibrateHostTree(double budget, std::vector<double>& evals_per_sec) {
+    evals_per_sec.assign(NUM_HOST_TREES, 0.0);
+    HostTreeKind best = HOST_FLAT;
+    for (int k = 0; k < NUM_HOST_TREES; k++) {
+        host_kind = (HostTreeKind)k;
+        evalSequencePair(false);
+        evalSequencePair(true);
+        long long evals = 0;
+        double elapsed = 0.0;
+        auto start = std::chrono::high_resolution_clock::now();
+        while (elapsed < budget / NUM_HOST_TREES) {
+            for (int i = 0; i < 16; i++) {
+                evalSequencePair(false);
+                evalSequencePair(true);
+            }
+            evals += 32;
+            elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        evals_per_sec[k] = evals / elapsed;
+        if (evals_per_sec[k] > evals_per_sec[best]) {
+            best = (HostTreeKind)k;
+        }
+    }
+    host_kind = best;
+    return best;
+}
+
+template <class T>
+typename T::Wire FastSP::netHPWLAs(Net* net) {
+    typedef typename T::Coord Coord;
     if (net->blocks.empty() && net->terminals.empty()) {
         return 0;
     }
 
-    int xmin = INT_MAX;
-    int xmax = INT_MIN;
-    int ymin = INT_MAX;
-    int ymax = INT_MIN;
+    Coord xmin = std::numeric_limits<Coord>::max();
+    Coord xmax = std::numeric_limits<Coord>::min();
+    Coord ymin = std::numeric_limits<Coord>::max();
+    Coord ymax = std::numeric_limits<Coord>::min();
 
     for (auto block : net->blocks) {
         Point* coord = block->getCoord();
-        int x = coord->x + block->getWidth() / 2;
-        int y = coord->y + block->getHeight() / 2;
+        Coord x = (Coord)coord->x + block->getWidth() / 2;
+        Coord y = (Coord)coord->y + block->getHeight() / 2;
         xmin = std::min(xmin, x);
         xmax = std::max(xmax, x);
         ymin = std::min(ymin, y);
@@ -558,32 +1416,134 @@ int FastSP::netHPWL(Net* net) {
 
     for (auto terminal : net->terminals) {
         Point* coord = terminal->getCoord();
-        xmin = std::min(xmin, coord->x);
-        xmax = std::max(xmax, coord->x);
-        ymin = std::min(ymin, coord->y);
-        ymax = std::max(ymax, coord->y);
+        xmin = std::min(xmin, (Coord)coord->x);
+        xmax = std::max(xmax, (Coord)coord->x);
+        ymin = std::min(ymin, (Coord)coord->y);
+        ymax = std::max(ymax, (Coord)coord->y);
     }
 
-    return (xmax - xmin) + (ymax - ymin);
+    return (typename T::Wire)(xmax - xmin) + (ymax - ymin);
 }
 
-int FastSP::totalHPWL() {
-    int total = 0;
+template <class T>
+typename T::Wire FastSP::totalHPWLAs() {
+    typename T::Wire total = 0;
     for (auto net : nets) {
-        total += netHPWL(net);
+        total += netHPWLAs<T>(net);
     }
     return total;
 }
 
+long long FastSP::netHPWL(Net* net) {
+    switch (cost_width) {
+    case COST_WIDTH_64:
+        return netHPWLAs<Cost64>(net);
+    case COST_WIDTH_MIXED:
+        return netHPWLAs<CostMixed>(net);
+    default:
+        return netHPWLAs<Cost32>(net);
+    }
+}
+
+long long FastSP::totalHPWL() {
+    switch (cost_width) {
+    case COST_WIDTH_64:
+        return totalHPWLAs<Cost64>();
+    case COST_WIDTH_MIXED:
+        return totalHPWLAs<CostMixed>();
+    default:
+        return totalHPWLAs<Cost32>();
+    }
+}
+
+//================================================================
+// Cost type selection
+//================================================================
+// Any packing is at most the sum of the longer block sides wide and
+// high, and every net spans at most the whole bounding box of blocks
+// and terminals. Cost32 is safe if the lengths, their product and the
+// summed net spans all fit in 32 bits. Only the product and the sum
+// outgrow the lengths, so CostMixed covers designs whose lengths still
+// fit, ami49 among them.
+//================================================================
+CostWidth FastSP::selectCostTypes() {
+    double max_x = outline.width;
+    double max_y = outline.height;
+    double sum = 0.0;
+    for (auto block : blocks) {
+        sum += std::max(block->getWidth(), block->getHeight());
+    }
+    max_x = std::max(max_x, sum);
+    max_y = std::max(max_y, sum);
+    for (auto terminal : terminals) {
+        max_x = std::max(max_x, (double)terminal->getCoord()->x);
+        max_y = std::max(max_y, (double)terminal->getCoord()->y);
+    }
+    const double limit = std::numeric_limits<int32_t>::max();
+    if (max_x + max_y > limit) {
+        cost_width = COST_WIDTH_64;
+    } else if (max_x * max_y > limit || (double)nets.size() * (max_x + max_y) > limit) {
+        cost_width = COST_WIDTH_MIXED;
+    } else {
+        cost_width = COST_WIDTH_32;
+    }
+    return cost_width;
+}
+
 SequencePair FastSP::deepCopySP(SequencePair& sp) {
     return sp;
 }
 
-double FastSP::costFunction(int len_x, int len_y) {
-    double cost = alpha * (len_x * len_y) + (1 - alpha) * totalHPWL();
+// Area-only and wirelength-only runs are picked when the dropped term
+// is zero anyway, so all three policies give the same cost
+CostModel FastSP::selectCostModel() {
+    if (num_nets == 0 || alpha >= 1.0) {
+        cost_model = COST_AREA;
+    } else if (alpha <= 0.0) {
+        cost_model = COST_WIRE;
+    } else {
+        cost_model = COST_MIXED;
+    }
+    return cost_model;
+}
+
+template <class T, class P>
+double FastSP::costAs(typename T::Coord len_x, typename T::Coord len_y) {
+    double cost = 0.0;
+    if (P::area) {
+        cost += alpha * ((typename T::Area)len_x * len_y);
+    }
+    if (P::wire) {
+        typename T::Wire wire = totalHPWLAs<T>();
+        last_wirelength = wire;
+        cost += (1 - alpha) * wire;
+    }
     return cost;
 }
 
+template <class T>
+double FastSP::costWith(typename T::Coord len_x, typename T::Coord len_y) {
+    switch (cost_model) {
+    case COST_AREA:
+        return costAs<T, AreaCost>(len_x, len_y);
+    case COST_WIRE:
+        return costAs<T, WireCost>(len_x, len_y);
+    default:
+        return costAs<T, MixedCost>(len_x, len_y);
+    }
+}
+
+double FastSP::costFunction(long long len_x, long long len_y) {
+    switch (cost_width) {
+    case COST_WIDTH_64:
+        return costWith<Cost64>(len_x, len_y);
+    case COST_WIDTH_MIXED:
+        return costWith<CostMixed>(len_x, len_y);
+    default:
+        return costWith<Cost32>(len_x, len_y);
+    }
+}
+
 void FastSP::outputBlocks(std::string filename = "output_blocks.txt") {
     evalSequencePair(false);
     evalSequencePair(true);
@@ -599,27 +1559,47 @@ void FastSP::outputHPWL(std::string filename) {
     std::ofstream file(filename);
     for (int i = 0; i < num_nets; i++) {
         Net* net = nets[i];
-        int hpwl = netHPWL(net);
+        long long hpwl = netHPWL(net);
         file << "Net: " << i << " " << hpwl << std::endl;
     }
     file.close();
 }
 
+std::pair<long long, long long> FastSP::place() {
+    long long len_x = evalSequencePair(false);
+    long long len_y = evalSequencePair(true);
+    return {len_x, len_y};
+}
+
 void FastSP::outputDump(std::string filename, double runtime) {
-    int len_x = evalSequencePair(false);
-    int len_y = evalSequencePair(true);
-    std::ofstream file(filename);
-    int total_wirelength = totalHPWL();
-    int cost = costFunction(len_x, len_y);
-    file << (int)cost << std::endl;
+    long long len_x = evalSequencePair(false);
+    long long len_y = evalSequencePair(true);
+    writeReport(filename, runtime, len_x, len_y);
+}
+
+// Write the current block coordinates, shared by every engine. The
+// report goes to a temporary file first and replaces `filename` by a
+// rename, so readers never see a partial report.
+bool FastSP::writeReport(std::string filename, double runtime, long long len_x, long long len_y, bool verbose) {
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream file(tmp_filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open output file " << tmp_filename << std::endl;
+        return false;
+    }
+    long long total_wirelength = totalHPWL();
+    long long cost = costFunction(len_x, len_y);
+    file << cost << std::endl;
     file << total_wirelength << std::endl;
     file << len_x*len_y << std::endl;
     file << len_x << " " << len_y << std::endl;
     file << runtime << std::endl;
-    std::cout << "Best cost: " << cost << std::endl;
-    std::cout << "Best size: " << len_x*len_y << std::endl;
-    std::cout << "Best X: " << len_x << std::endl;
-    std::cout << "Best Y: " << len_y << std::endl;
+    if (verbose) {
+        std::cout << "Best cost: " << cost << std::endl;
+        std::cout << "Best size: " << len_x*len_y << std::endl;
+        std::cout << "Best X: " << len_x << std::endl;
+        std::cout << "Best Y: " << len_y << std::endl;
+    }
     for (int i = 1; i < num_blocks+1; i++) {
         Block* block = blocks[i-1];
         file << block->getName() << " " << block->getCoordX() << " " << block->getCoordY() << " " << block->getCoordX()+block->getWidth() << " " << block->getCoordY()+block->getHeight() << std::endl;
@@ -634,15 +1614,219 @@ void FastSP::outputDump(std::string filename, double runtime) {
     //     std::cout << block->getName() << ": " << block->getCoordX() << " " << block->getCoordY() << " " << block->getCoordX()+block->getWidth() << " " << block->getCoordY()+block->getHeight() << std::endl;
     // }
     file.close();
+    if (!file) {
+        std::cerr << "Error: Failed to write output file " << tmp_filename << std::endl;
+        return false;
+    }
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Error: Unable to replace output file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void FastSP::writeSnapshot(std::string filename, double runtime) {
+    long long len_x = evalSequencePair(false);
+    long long len_y = evalSequencePair(true);
+    writeReport(filename, runtime, len_x, len_y, false);
 }
 
+// The best sequence pair is swapped in and the journaled rotations are
+// flipped for the write, then both are put back. The coordinates are
+// left at the best packing, the anneal evaluates before it reads them.
+void FastSP::writeBestSnapshot(std::string filename, double runtime) {
+    std::vector<int> flipped;
+    for (int k = 0; k < journal.num_rot; k++) {
+        int i = journal.rot[k];
+        if (blocks[i-1]->isRotated() != best_rotated.test(i)) {
+            blocks[i-1]->rotate90();
+            flipped.push_back(i);
+        }
+    }
+    std::swap(sp, best_sp);
+    writeSnapshot(filename, runtime);
+    std::swap(sp, best_sp);
+    for (int i : flipped) {
+        blocks[i-1]->rotate90();
+    }
+}
+
+// Only the sequence pair and the rotations are copied, coordinates are
+// recomputed by the next evalSequencePair. Replicas that already hold
+// the other's solution (neither improved since the last copy) skip it.
 void FastSP::copySolution(FastSP* other) {
-    sp = other->sp;
+    if (solution_tag == other->solution_tag) {
+        return;
+    }
+    if (sp.x.size() != num_blocks+1) {
+        layoutState();
+    }
+    sp.x.copyFrom(other->sp.x);
+    sp.y.copyFrom(other->sp.y);
     for (int i = 0; i < num_blocks; i++) {
-        blocks[i]->setCoordX(other->blocks[i]->getCoordX());
-        blocks[i]->setCoordY(other->blocks[i]->getCoordY());
         if (blocks[i]->isRotated() != other->blocks[i]->isRotated()) {
             blocks[i]->rotate90();
         }
     }
-}
\ No newline at end of file
+    solution_tag = other->solution_tag;
+}
+
+// Replicas on other NUMA nodes read the best solution as one compact
+// message instead of the best replica's vectors and Block objects:
+// 16-bit sequence pair entries when they fit, rotations as a bitset.
+void FastSP::packSolution(SolutionMessage& message) {
+    message.tag = solution_tag;
+    message.num_blocks = num_blocks;
+    message.order16.clear();
+    message.order32.clear();
+    if (sp.x.isNarrow()) {
+        message.order16.resize(2 * num_blocks);
+        std::memcpy(&message.order16[0], sp.x.data(uint16_t()) + 1, num_blocks * sizeof(uint16_t));
+        std::memcpy(&message.order16[num_blocks], sp.y.data(uint16_t()) + 1, num_blocks * sizeof(uint16_t));
+    } else {
+        message.order32.resize(2 * num_blocks);
+        for (int i = 0; i < num_blocks; i++) {
+            message.order32[i] = sp.x[i+1];
+            message.order32[num_blocks + i] = sp.y[i+1];
+        }
+    }
+    message.rotated.assign((num_blocks + 63) / 64, 0);
+    for (int i = 0; i < num_blocks; i++) {
+        if (blocks[i]->isRotated()) {
+            message.rotated[i / 64] |= 1ULL << (i % 64);
+        }
+    }
+}
+
+void FastSP::copySolution(const SolutionMessage& message) {
+    if (solution_tag == message.tag) {
+        return;
+    }
+    if (sp.x.size() != num_blocks+1) {
+        layoutState();
+    }
+    for (int i = 0; i < num_blocks; i++) {
+        sp.x.set(i+1, message.order16.empty() ? message.order32[i] : message.order16[i]);
+        sp.y.set(i+1, message.order16.empty() ? message.order32[num_blocks + i] : message.order16[num_blocks + i]);
+    }
+    for (int i = 0; i < num_blocks; i++) {
+        bool rotated = (message.rotated[i / 64] >> (i % 64)) & 1;
+        if (blocks[i]->isRotated() != rotated) {
+            blocks[i]->rotate90();
+        }
+    }
+    solution_tag = message.tag;
+}
+
+//================================================================
+// Replica state (de)serialization for checkpoints
+//================================================================
+// Layout (native endianness):
+//   uint32 seed | double init_temp | uint8 warm_started |
+//   uint32 rng_len | rng state text
+//   int32 sp.x[1..n] | int32 sp.y[1..n] | rotation bits, 8 blocks per byte
+//================================================================
+void FastSP::saveState(std::ostream& out) {
+    std::ostringstream rng_state;
+    rng_state << rng;
+    std::string rng_str = rng_state.str();
+    uint32_t rng_len = rng_str.size();
+
+    out.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+    out.write(reinterpret_cast<const char*>(&init_temp), sizeof(init_temp));
+    uint8_t warm = warm_started;
+    out.write(reinterpret_cast<const char*>(&warm), sizeof(warm));
+    out.write(reinterpret_cast<const char*>(&rng_len), sizeof(rng_len));
+    out.write(rng_str.data(), rng_len);
+    std::vector<int32_t> order(2 * num_blocks);
+    for (int i = 0; i < num_blocks; i++) {
+        order[i] = sp.x[i+1];
+        order[num_blocks + i] = sp.y[i+1];
+    }
+    out.write(reinterpret_cast<const char*>(order.data()), order.size() * sizeof(int32_t));
+    std::vector<uint8_t> rotated((num_blocks + 7) / 8, 0);
+    for (int i = 0; i < num_blocks; i++) {
+        if (blocks[i]->isRotated()) {
+            rotated[i / 8] |= (1 << (i % 8));
+        }
+    }
+    out.write(reinterpret_cast<const char*>(rotated.data()), rotated.size());
+}
+
+// Longest text `operator<<` writes for a RngEngine: as many words as a
+// default engine writes, each with the digits of the largest uint64
+static size_t maxRngStateLength() {
+    std::ostringstream state;
+    state << RngEngine();
+    std::istringstream words(state.str());
+    std::string word;
+    size_t num_words = 0;
+    while (words >> word) {
+        num_words++;
+    }
+    return num_words * (std::numeric_limits<uint64_t>::digits10 + 2);
+}
+
+bool FastSP::loadState(std::istream& in) {
+    uint32_t rng_len = 0;
+    uint8_t warm = 0;
+    in.read(reinterpret_cast<char*>(&seed), sizeof(seed));
+    in.read(reinterpret_cast<char*>(&init_temp), sizeof(init_temp));
+    in.read(reinterpret_cast<char*>(&warm), sizeof(warm));
+    warm_started = warm != 0;
+    in.read(reinterpret_cast<char*>(&rng_len), sizeof(rng_len));
+    if (!in || rng_len == 0 || rng_len > maxRngStateLength()) {
+        return false;
+    }
+    std::string rng_str(rng_len, '\0');
+    in.read(&rng_str[0], rng_len);
+    std::istringstream rng_state(rng_str);
+    rng_state >> rng;
+    // The whole text must be one state of this engine
+    bool parsed = !rng_state.fail();
+    rng_state >> std::ws;
+    if (!in || !parsed || !rng_state.eof()) {
+        return false;
+    }
+    seeded = true;
+
+    resetSequencePair();
+    std::vector<int32_t> order(2 * num_blocks);
+    in.read(reinterpret_cast<char*>(order.data()), order.size() * sizeof(int32_t));
+    std::vector<uint8_t> rotated((num_blocks + 7) / 8, 0);
+    in.read(reinterpret_cast<char*>(rotated.data()), rotated.size());
+    if (!in) {
+        return false;
+    }
+    // Both sequences must be permutations of {1 ... n}
+    std::vector<bool> seen_x(num_blocks+1, false);
+    std::vector<bool> seen_y(num_blocks+1, false);
+    for (int i = 0; i < num_blocks; i++) {
+        int x = order[i];
+        int y = order[num_blocks + i];
+        if (x < 1 || x > num_blocks || seen_x[x] ||
+            y < 1 || y > num_blocks || seen_y[y]) {
+            return false;
+        }
+        seen_x[x] = true;
+        seen_y[y] = true;
+        sp.x.set(i+1, x);
+        sp.y.set(i+1, y);
+    }
+    for (int i = 0; i < num_blocks; i++) {
+        bool r = (rotated[i / 8] >> (i % 8)) & 1;
+        if (blocks[i]->isRotated() != r) {
+            blocks[i]->rotate90();
+        }
+    }
+    return true;
+}
+
+// Derive an independent per-replica seed from the master seed (SplitMix64)
+uint32_t FastSP::splitSeed(uint64_t master_seed, int index) {
+    uint64_t z = master_seed + (uint64_t)(index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return (uint32_t)(z ^ (z >> 32));
+}
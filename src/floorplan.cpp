@@ -0,0 +1,649 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <tuple>
+#include <unordered_map>
+#include <omp.h>
+#include "floorplan.h"
+#include "fast_sp.h"
+#include "checkpoint.h"
+#include "multilevel.h"
+#include "island.h"
+#include "bstar.h"
+#include "affinity.h"
+#include "anytime.h"
+#include "pareto.h"
+
+//================================================================
+// Design input
+//================================================================
+bool loadDesign(double alpha, std::string block_file, std::string net_file, FloorplanDesign& design) {
+    FastSP fastsp(alpha, block_file, net_file);
+    design = FloorplanDesign();
+    design.alpha = alpha;
+    design.outline_width = fastsp.getOutline().width;
+    design.outline_height = fastsp.getOutline().height;
+
+    std::unordered_map<Block*, int> block_index;
+    std::unordered_map<Terminal*, int> terminal_index;
+    for (auto block : fastsp.getBlocks()) {
+        block_index[block] = design.blocks.size();
+        design.blocks.push_back({block->getName(), block->getWidth(), block->getHeight()});
+    }
+    for (auto terminal : fastsp.getTerminals()) {
+        terminal_index[terminal] = design.terminals.size();
+        design.terminals.push_back({terminal->getName(), (int)terminal->getCoord()->x, (int)terminal->getCoord()->y});
+    }
+    for (auto net : fastsp.getNets()) {
+        FloorplanNet pins;
+        for (auto block : net->blocks) {
+            pins.blocks.push_back(block_index[block]);
+        }
+        for (auto terminal : net->terminals) {
+            pins.terminals.push_back(terminal_index[terminal]);
+        }
+        design.nets.push_back(pins);
+    }
+    return !design.blocks.empty();
+}
+
+// The design as a `FastSP` instance, owned by the caller
+static FastSP* buildDesign(const FloorplanDesign& design) {
+    FastSP* fastsp = new FastSP(design.alpha, Outline{design.outline_width, design.outline_height});
+    for (auto& block : design.blocks) {
+        fastsp->addBlock(block.name, block.width, block.height);
+    }
+    for (auto& terminal : design.terminals) {
+        fastsp->addTerminal(terminal.name, terminal.x, terminal.y);
+    }
+    for (auto& net : design.nets) {
+        fastsp->addNet(net.blocks, net.terminals);
+    }
+    fastsp->selectCostTypes();
+    fastsp->selectCostModel();
+    return fastsp;
+}
+
+static bool validDesign(const FloorplanDesign& design) {
+    if (design.blocks.empty()) {
+        std::cerr << "Error: Design has no blocks" << std::endl;
+        return false;
+    }
+    for (auto& block : design.blocks) {
+        if (block.width <= 0 || block.height <= 0) {
+            std::cerr << "Error: Block " << block.name << " has no area" << std::endl;
+            return false;
+        }
+    }
+    int num_blocks = design.blocks.size();
+    int num_terminals = design.terminals.size();
+    for (size_t i = 0; i < design.nets.size(); i++) {
+        for (int id : design.nets[i].blocks) {
+            if (id < 0 || id >= num_blocks) {
+                std::cerr << "Error: Net " << i << " has an invalid block index " << id << std::endl;
+                return false;
+            }
+        }
+        for (int id : design.nets[i].terminals) {
+            if (id < 0 || id >= num_terminals) {
+                std::cerr << "Error: Net " << i << " has an invalid terminal index " << id << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool validOptions(const FloorplanOptions& opt) {
+    if (opt.engine != "sp" && opt.engine != "bstar") {
+        std::cerr << "Error: Unknown engine " << opt.engine << std::endl;
+        return false;
+    }
+    if (opt.host_tree != "auto" && std::find(HOST_TREE_NAMES, HOST_TREE_NAMES + NUM_HOST_TREES, opt.host_tree) == HOST_TREE_NAMES + NUM_HOST_TREES) {
+        std::cerr << "Error: Unknown host tree " << opt.host_tree << std::endl;
+        return false;
+    }
+    if (opt.cost_bits != "auto" && std::find(COST_WIDTH_NAMES, COST_WIDTH_NAMES + NUM_COST_WIDTHS, opt.cost_bits) == COST_WIDTH_NAMES + NUM_COST_WIDTHS) {
+        std::cerr << "Error: Unknown cost width " << opt.cost_bits << std::endl;
+        return false;
+    }
+    if (!opt.pin_policy.empty() && opt.pin_policy != "compact" && opt.pin_policy != "spread") {
+        std::cerr << "Error: Unknown pinning policy " << opt.pin_policy << std::endl;
+        return false;
+    }
+    if (opt.init_mode != "shelf" && opt.init_mode != "random") {
+        std::cerr << "Error: Unknown init mode " << opt.init_mode << std::endl;
+        return false;
+    }
+    for (double a : opt.sweep_alphas) {
+        if (a < 0.0 || a > 1.0) {
+            std::cerr << "Error: Sweep alpha " << a << " is not in [0, 1]" << std::endl;
+            return false;
+        }
+    }
+    // Replicas of different alphas have incomparable costs
+    if (!opt.sweep_alphas.empty() && (opt.engine != "sp" || !opt.checkpoint_file.empty() || !opt.resume_file.empty() ||
+                                      !opt.worker_address.empty())) {
+        std::cerr << "Error: --sweep needs --engine sp and cannot be combined with --checkpoint, --resume or --worker" << std::endl;
+        return false;
+    }
+    // These store or exchange sequence pairs
+    if (opt.engine == "bstar" && (!opt.checkpoint_file.empty() || !opt.resume_file.empty() || !opt.warm_start_file.empty() ||
+                                  opt.multilevel || !opt.worker_address.empty())) {
+        std::cerr << "Error: --checkpoint, --resume, --warm-start, --multilevel and --worker need --engine sp" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//================================================================
+// Replica rounds
+//================================================================
+// Every round anneals all replicas in parallel, then the best one is
+// copied to the others. The best replica of the last round is
+// compacted and returned.
+//
+// In an alpha sweep, replica j anneals with alpha j % k of the k sweep
+// alphas and only shares its best with replicas of the same alpha.
+// All replicas feed one Pareto archive, the returned solution is the
+// archive entry with the lowest cost at the design alpha.
+//================================================================
+static std::vector<FloorplanPlacement> placements(FastSP* fastsp) {
+    std::vector<FloorplanPlacement> blocks;
+    for (auto block : fastsp->getBlocks()) {
+        blocks.push_back({block->getCoordX(), block->getCoordY(), block->getWidth(), block->getHeight(), block->isRotated()});
+    }
+    return blocks;
+}
+
+static bool writeParetoSummary(std::string filename, const FloorplanDesign& design, const FloorplanOptions& opt,
+                               const std::vector<FloorplanParetoPoint>& front, const std::vector<std::string>& reports) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open output file " << filename << std::endl;
+        return false;
+    }
+    file << "# Pareto front of " << front.size() << " solutions, report costs use alpha " << design.alpha << std::endl;
+    file << "# point area wirelength width height alpha report" << std::endl;
+    for (size_t k = 0; k < front.size(); k++) {
+        const FloorplanParetoPoint& p = front[k];
+        file << k << " " << p.area << " " << p.wirelength << " " << p.width << " " << p.height << " " << p.alpha << " " << reports[k] << std::endl;
+    }
+    file << "# best point per sweep alpha" << std::endl;
+    file << "# alpha point cost" << std::endl;
+    for (double a : opt.sweep_alphas) {
+        int best = -1;
+        double best_cost = DBL_MAX;
+        for (size_t k = 0; k < front.size(); k++) {
+            double cost = a * front[k].area + (1 - a) * front[k].wirelength;
+            if (cost < best_cost) {
+                best_cost = cost;
+                best = k;
+            }
+        }
+        file << a << " " << best << " " << (long long)best_cost << std::endl;
+    }
+    return true;
+}
+
+
+bool runFloorplan(const FloorplanDesign& design, const FloorplanOptions& opt, FloorplanResult& result) {
+    if (!validDesign(design) || !validOptions(opt)) {
+        return false;
+    }
+    resetStopRequest();
+    bool verbose = opt.verbose;
+    bool sweep = !opt.sweep_alphas.empty();
+    int num_threads = opt.num_threads > 0 ? opt.num_threads : omp_get_max_threads();
+    int num_runs = sweep ? std::max<int>(num_threads, opt.sweep_alphas.size()) : num_threads;
+    int num_groups = sweep ? opt.sweep_alphas.size() : 1;
+    int start_round = 0;
+
+    std::vector<double> costs(num_runs);
+
+    // Pin before the replicas are constructed, so each one is first
+    // touched on the node of the thread that anneals it. Every parallel
+    // loop over replicas uses the same static schedule. The threads,
+    // including the caller's, get their masks back on every return.
+    struct PinnedTeam {
+        int num_threads = 0;
+        SavedAffinity saved;
+        ~PinnedTeam() {
+            if (num_threads > 0) {
+                unpinThreads(num_threads, saved);
+            }
+        }
+    } pinned;
+    if (!opt.pin_policy.empty()) {
+        std::vector<ThreadPlacement> placements;
+        pinned.num_threads = num_threads;
+        if (pinThreads(opt.pin_policy, num_threads, placements, pinned.saved) && verbose) {
+            std::cout << "Pinned threads (" << opt.pin_policy << "):";
+            for (size_t t = 0; t < placements.size(); t++) {
+                std::cout << " " << t << "->cpu" << placements[t].cpu << "/node" << placements[t].node;
+            }
+            std::cout << std::endl;
+        }
+    }
+    std::vector<FastSP*> fastsp_instances(num_runs);
+    std::vector<FloorplanEngine*> engines(num_runs);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int i = 0; i < num_runs; ++i) {
+        fastsp_instances[i] = buildDesign(design);
+    }
+
+    // Every replica selected its width from the design on build
+    CostWidth cost_width = fastsp_instances[0]->getCostWidth();
+    if (opt.cost_bits != "auto") {
+        CostWidth requested = (CostWidth)(std::find(COST_WIDTH_NAMES, COST_WIDTH_NAMES + NUM_COST_WIDTHS, opt.cost_bits) - COST_WIDTH_NAMES);
+        if (requested < cost_width) {
+            std::cerr << "Error: Design does not fit " << opt.cost_bits << " cost types, it needs " << COST_WIDTH_NAMES[cost_width] << std::endl;
+            for (int i = 0; i < num_runs; ++i) {
+                delete fastsp_instances[i];
+            }
+            return false;
+        }
+        cost_width = requested;
+        for (int i = 0; i < num_runs; ++i) {
+            fastsp_instances[i]->setCostWidth(cost_width);
+        }
+    }
+    if (verbose) {
+        const char* const descriptions[NUM_COST_WIDTHS] = {"32-bit", "32-bit coordinates, 64-bit area/wirelength", "64-bit"};
+        std::cout << "Cost types: " << descriptions[cost_width] << ", " << COST_MODEL_NAMES[fastsp_instances[0]->getCostModel()] << std::endl;
+    }
+
+    // Workers seed their replicas apart from the other workers
+    IslandWorker island;
+    int seed_offset = 0;
+    if (!opt.worker_address.empty()) {
+        if (!island.connect(opt.worker_address, fastsp_instances[0])) {
+            for (int i = 0; i < num_runs; ++i) {
+                delete fastsp_instances[i];
+            }
+            return false;
+        }
+        seed_offset = island.getWorkerId() * num_runs;
+        if (verbose) {
+            std::cout << "Connected as worker " << island.getWorkerId() << " of " << island.getNumWorkers() << std::endl;
+        }
+    }
+
+    // Initial solution, in order of precedence: checkpoint, warm start,
+    // multilevel projection, init mode. A failed warm start is an error,
+    // it never falls back to another initializer.
+    bool use_multilevel = opt.multilevel && opt.resume_file.empty() && opt.warm_start_file.empty();
+    if (verbose && opt.multilevel && !use_multilevel) {
+        std::cout << "Multilevel skipped, the replicas start from the " << (opt.resume_file.empty() ? "warm start" : "checkpoint") << std::endl;
+    }
+    // The checkpoint is only read here. Each replica restores its state
+    // in the loop below, on the thread that anneals it.
+    Checkpoint ckpt;
+    if (!opt.resume_file.empty() && !loadCheckpoint(opt.resume_file, fastsp_instances, ckpt)) {
+        for (int i = 0; i < num_runs; ++i) {
+            delete fastsp_instances[i];
+        }
+        return false;
+    }
+    // The warm start report is read once as well, the replicas are
+    // identical so it places the same blocks for all of them
+    std::vector<WarmPlacement> warm_placed;
+    if (opt.resume_file.empty() && !opt.warm_start_file.empty() &&
+        !fastsp_instances[0]->readWarmStart(opt.warm_start_file, warm_placed)) {
+        std::cerr << "Error: Warm start from " << opt.warm_start_file << " failed" << std::endl;
+        for (int i = 0; i < num_runs; ++i) {
+            delete fastsp_instances[i];
+        }
+        return false;
+    }
+    int resume_failed = 0;
+    #pragma omp parallel for num_threads(num_threads) schedule(static) reduction(+:resume_failed)
+    for (int i = 0; i < num_runs; ++i) {
+        FastSP* fastsp = fastsp_instances[i];
+        if (opt.seeded) {
+            fastsp->setSeed(FastSP::splitSeed(opt.seed, seed_offset + i));
+        }
+        engines[i] = fastsp;
+        if (opt.engine == "bstar") {
+            BStarTree* bstar = new BStarTree(fastsp);
+            bstar->initialize();
+            engines[i] = bstar;
+        } else if (!opt.resume_file.empty()) {
+            if (!loadReplicaState(fastsp, ckpt.states[i])) {
+                resume_failed++;
+            }
+        } else if (!opt.warm_start_file.empty()) {
+            fastsp->warmStart(warm_placed);
+            fastsp->setInitTemp(opt.warm_temp);
+        } else if (use_multilevel) {
+            // The solution is projected from the coarse levels below
+        } else if (opt.init_mode == "shelf") {
+            fastsp->initializeShelf();
+        } else {
+            fastsp->initialize();
+        }
+    }
+
+    if (resume_failed > 0) {
+        std::cerr << "Error: Corrupted replica state in checkpoint file " << opt.resume_file << std::endl;
+        for (int i = 0; i < num_runs; ++i) {
+            delete fastsp_instances[i];
+        }
+        return false;
+    }
+
+    if (use_multilevel) {
+        MultilevelOptions ml_opt = {num_runs, opt.ml_target, opt.ml_level_time, opt.max_iterations, opt.warm_temp, opt.seeded, opt.seed, verbose};
+        SequencePair ml_sp;
+        std::vector<char> ml_rotated;
+        bool projected = runMultilevel(fastsp_instances[0], ml_opt, ml_sp, ml_rotated);
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for (int i = 0; i < num_runs; ++i) {
+            if (projected) {
+                fastsp_instances[i]->setSolution(ml_sp, ml_rotated);
+                fastsp_instances[i]->initRng();
+                fastsp_instances[i]->setInitTemp(opt.warm_temp);
+            } else if (opt.init_mode == "shelf") {
+                fastsp_instances[i]->initializeShelf();
+            } else {
+                fastsp_instances[i]->initialize();
+            }
+        }
+    }
+
+    double init_time = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+    if (verbose) {
+        std::cout << "Initialized in " << init_time << " Sec" << std::endl;
+    }
+
+    if (!opt.resume_file.empty()) {
+        start_round = ckpt.next_round;
+        costs = ckpt.costs;
+        if (verbose) {
+            std::cout << "Resumed from " << opt.resume_file << " at round " << start_round << std::endl;
+        }
+    }
+
+    if (opt.engine == "sp") {
+        HostTreeKind kind = HOST_FLAT;
+        if (opt.host_tree == "auto") {
+            std::vector<double> evals_per_sec;
+            kind = fastsp_instances[0]->calibrateHostTree(0.1, evals_per_sec);
+            if (verbose) {
+                std::cout << "Host tree calibration:";
+                for (int k = 0; k < NUM_HOST_TREES; k++) {
+                    std::cout << " " << HOST_TREE_NAMES[k] << " " << (long long)evals_per_sec[k];
+                }
+                std::cout << " packings/s" << std::endl;
+            }
+        } else {
+            kind = (HostTreeKind)(std::find(HOST_TREE_NAMES, HOST_TREE_NAMES + NUM_HOST_TREES, opt.host_tree) - HOST_TREE_NAMES);
+        }
+        for (int i = 0; i < num_runs; ++i) {
+            fastsp_instances[i]->setHostTree(kind);
+        }
+        if (verbose) {
+            std::cout << "Host tree: " << HOST_TREE_NAMES[kind] << std::endl;
+        }
+    }
+
+    // Every accepted legal packing goes to the archive of its replica,
+    // the wirelength is needed even at alpha 1
+    std::vector<ParetoArchive> archives(num_runs, ParetoArchive(opt.pareto_size));
+    ParetoArchive front(opt.pareto_size);
+    if (sweep) {
+        for (int i = 0; i < num_runs; ++i) {
+            FastSP* fastsp = fastsp_instances[i];
+            fastsp->setAlpha(opt.sweep_alphas[i % num_groups]);
+            if (fastsp->getCostModel() == COST_AREA && !fastsp->getNets().empty()) {
+                fastsp->setCostModel(COST_MIXED);
+            }
+            fastsp->setArchive(&archives[i]);
+        }
+        if (verbose) {
+            std::cout << "Alpha sweep: " << num_groups << " alphas on " << num_runs << " replicas" << std::endl;
+        }
+    }
+
+    // Replicas write the report whenever the global best improves
+    bool snapshots = opt.snapshots && !opt.report_file.empty() && !sweep;
+    AnytimeReport anytime(opt.report_file, opt.snapshot_interval, start);
+    if (snapshots) {
+        for (int i = 0; i < num_runs; ++i) {
+            engines[i]->setAnytime(&anytime);
+        }
+    }
+
+    auto anneal_start = std::chrono::high_resolution_clock::now();
+    for (int i = start_round; i < opt.num_rounds; ++i) {
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for (int j = 0; j < num_runs; ++j) {
+            double cost = engines[j]->run(opt.round_time, opt.max_iterations);
+            costs[j] = cost;
+        }
+        // Find the best solution (of each alpha)
+        // Copy the best solution to all instances (of the same alpha)
+        // Run the instances again
+        std::vector<int> group_best(num_groups, -1);
+        for (int j = 0; j < num_runs; ++j) {
+            int g = j % num_groups;
+            if (group_best[g] == -1 || costs[j] < costs[group_best[g]]) {
+                group_best[g] = j;
+            }
+        }
+        int min_index = group_best[0];
+        double min_cost = costs[min_index];
+
+        if (verbose) {
+            if (sweep) {
+                for (int g = 0; g < num_groups; ++g) {
+                    std::cout << "Min Cost (alpha " << opt.sweep_alphas[g] << "): " << costs[group_best[g]] << std::endl;
+                }
+            } else {
+                std::cout << "Min Cost: " << min_cost << std::endl;
+            }
+        }
+
+        // Each replica pulls the compact best solution into its own
+        // memory from its own thread
+        if (opt.engine == "sp") {
+            std::vector<SolutionMessage> messages(num_groups);
+            for (int g = 0; g < num_groups; ++g) {
+                fastsp_instances[group_best[g]]->packSolution(messages[g]);
+            }
+            #pragma omp parallel for num_threads(num_threads) schedule(static)
+            for (int j = 0; j < num_runs; ++j) {
+                if (j != group_best[j % num_groups]) {
+                    fastsp_instances[j]->copySolution(messages[j % num_groups]);
+                }
+            }
+        } else {
+            #pragma omp parallel for num_threads(num_threads) schedule(static)
+            for (int j = 0; j < num_runs; ++j) {
+                if (j != group_best[j % num_groups]) {
+                    engines[j]->copySolution(engines[group_best[j % num_groups]]);
+                }
+            }
+        }
+
+        if (sweep) {
+            for (int j = 0; j < num_runs; ++j) {
+                front.merge(archives[j]);
+                archives[j].clear();
+            }
+            if (verbose) {
+                std::cout << "Pareto front: " << front.getEntries().size() << " solutions" << std::endl;
+            }
+        }
+
+        if (snapshots) {
+            anytime.flush(engines[min_index], min_cost);
+        }
+
+        // Island migration, adopt the migrant if it beats the local best
+        if (!opt.worker_address.empty() && (i + 1) % opt.migrate_every == 0 && i + 1 < opt.num_rounds && !stopRequested()) {
+            IslandSolution migrant;
+            if (island.exchange(captureSolution(fastsp_instances[min_index], min_cost), migrant) &&
+                migrant.cost < min_cost) {
+                for (int j = 0; j < num_runs; ++j) {
+                    fastsp_instances[j]->setSolution(migrant.sp, migrant.rotated);
+                    costs[j] = migrant.cost;
+                }
+                if (verbose) {
+                    std::cout << "Adopted migrant with cost " << migrant.cost << std::endl;
+                }
+            }
+        }
+
+        if (!opt.checkpoint_file.empty() && ((i + 1) % opt.checkpoint_every == 0 || i + 1 == opt.num_rounds || stopRequested())) {
+            Checkpoint round_ckpt = {i + 1, min_index, costs, {}};
+            saveCheckpoint(opt.checkpoint_file, fastsp_instances, round_ckpt);
+        }
+
+        if (stopRequested()) {
+            if (verbose) {
+                std::cout << "Stop requested, writing the best solution" << std::endl;
+            }
+            break;
+        }
+    }
+
+    if (opt.engine == "sp" && verbose) {
+        double anneal_time = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - anneal_start).count();
+        long long evaluated = 0;
+        for (int i = 0; i < num_runs; ++i) {
+            evaluated += fastsp_instances[i]->getEvaluatedMoves();
+        }
+        std::cout << "Evaluated " << evaluated << " moves, " << (long long)(evaluated / std::max(anneal_time, 1e-9)) << " moves/s" << std::endl;
+    }
+
+    double min_cost = costs[0];
+    int min_index = 0;
+    for (int i = 1; i < num_runs; ++i) {
+        if (costs[i] < min_cost) {
+            min_cost = costs[i];
+            min_index = i;
+        }
+    }
+
+    // The archive entry that is best at the design alpha continues in
+    // replica 0, which is also used to place the other entries below
+    FastSP* target = fastsp_instances[0];
+    double target_alpha = design.alpha;
+    if (sweep) {
+        for (int i = 0; i < num_runs; ++i) {
+            fastsp_instances[i]->setArchive(nullptr);
+        }
+        target->setAlpha(design.alpha);
+        min_index = 0;
+        min_cost = DBL_MAX;
+        for (auto& entry : front.getEntries()) {
+            double cost = design.alpha * entry.area + (1 - design.alpha) * entry.wirelength;
+            if (cost < min_cost) {
+                min_cost = cost;
+                target_alpha = entry.alpha;
+                target->copySolution(entry.solution);
+            }
+        }
+    }
+
+    if (opt.engine == "sp" && opt.compact_time > 0 && !stopRequested()) {
+        auto compact_start = std::chrono::high_resolution_clock::now();
+        // Bounded by block placements, so seeded or budgeted runs stay
+        // reproducible. The time limit only applies to the others.
+        long long max_placements = opt.compact_placements > 0 ? opt.compact_placements : COMPACT_PLACEMENTS;
+        bool reproducible = opt.seeded || opt.max_iterations > 0;
+        int accepted = fastsp_instances[min_index]->compact(max_placements, reproducible ? 0.0 : opt.compact_time);
+        double compact_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - compact_start).count();
+        if (verbose) {
+            std::cout << "Compaction: " << accepted << " moves in " << compact_elapsed * 1000 << " ms" << std::endl;
+        }
+        long long len_x = fastsp_instances[min_index]->evalSequencePair(false);
+        long long len_y = fastsp_instances[min_index]->evalSequencePair(true);
+        min_cost = fastsp_instances[min_index]->costFunction(len_x, len_y);
+        if (sweep && len_x <= target->getOutline().width && len_y <= target->getOutline().height) {
+            // Compaction refines the entry, it keeps the alpha that found it
+            front.offer(target, len_x, len_y, target->totalHPWL(), target_alpha);
+        }
+    }
+
+    if (!opt.worker_address.empty()) {
+        island.finish(captureSolution(fastsp_instances[min_index], min_cost));
+    }
+
+    auto stop = std::chrono::high_resolution_clock::now();
+    double runtime = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+
+    if (!opt.report_file.empty()) {
+        if (verbose) {
+            engines[min_index]->outputDump(opt.report_file, runtime);
+        } else {
+            engines[min_index]->writeSnapshot(opt.report_file, runtime);
+        }
+    }
+
+    // The placement of the best replica
+    FastSP* best = fastsp_instances[min_index];
+    long long len_x, len_y;
+    std::tie(len_x, len_y) = engines[min_index]->place();
+    Outline outline = best->getOutline();
+    result.legal = len_x <= outline.width && len_y <= outline.height;
+    result.cost = best->costFunction(len_x, len_y);
+    result.width = len_x;
+    result.height = len_y;
+    result.wirelength = best->totalHPWL();
+    result.runtime = runtime;
+    result.blocks = placements(best);
+
+    // One report per archive entry, next to the main report
+    result.pareto.clear();
+    if (sweep) {
+        std::string stem = opt.report_file;
+        if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".rpt") == 0) {
+            stem.erase(stem.size() - 4);
+        }
+        std::vector<std::string> reports;
+        for (auto& entry : front.getEntries()) {
+            target->copySolution(entry.solution);
+            std::tie(len_x, len_y) = target->place();
+            result.pareto.push_back({entry.area, entry.wirelength, len_x, len_y, entry.alpha, placements(target)});
+            if (!opt.report_file.empty()) {
+                reports.push_back(stem + ".pareto" + std::to_string(reports.size()) + ".rpt");
+                target->writeReport(reports.back(), runtime, len_x, len_y, false);
+            }
+        }
+        if (!opt.report_file.empty()) {
+            // Reports of a larger front from an earlier run would look
+            // like points of this one
+            for (size_t k = reports.size(); std::remove((stem + ".pareto" + std::to_string(k) + ".rpt").c_str()) == 0; k++) {
+            }
+            std::string summary = stem + ".pareto.txt";
+            writeParetoSummary(summary, design, opt, result.pareto, reports);
+            if (verbose) {
+                std::cout << "Pareto front of " << result.pareto.size() << " solutions written to " << summary << std::endl;
+            }
+        }
+    }
+
+    for (int i = 0; i < num_runs; ++i) {
+        delete engines[i];
+    }
+    return true;
+}
+
+bool runFloorplanCoordinator(const FloorplanDesign& design, std::string address, int num_workers,
+                             std::string topology, std::string report_file, double accept_timeout, double exchange_timeout) {
+    if (!validDesign(design)) {
+        return false;
+    }
+    FastSP* fastsp = buildDesign(design);
+    bool ok = runCoordinator(address, num_workers, topology, fastsp, report_file, accept_timeout, exchange_timeout);
+    delete fastsp;
+    return ok;
+}
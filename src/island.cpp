@@ -0,0 +1,434 @@
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "island.h"
+
+enum IslandMessage : uint32_t {
+    MSG_HELLO = 1,
+    MSG_WELCOME = 2,
+    MSG_BEST = 3,
+    MSG_MIGRANT = 4,
+    MSG_DONE = 5,
+};
+
+//================================================================
+// Socket helpers
+//================================================================
+static bool sendAll(int fd, const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool recvAll(int fd, void* data, size_t len) {
+    char* p = static_cast<char*>(data);
+    while (len > 0) {
+        ssize_t n = ::recv(fd, p, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool sendMessage(int fd, uint32_t type, const std::string& payload) {
+    uint32_t header[3] = {ISLAND_MAGIC, type, (uint32_t)payload.size()};
+    return sendAll(fd, header, sizeof(header)) && sendAll(fd, payload.data(), payload.size());
+}
+
+// Payloads longer than `max_length` are rejected before allocating
+bool recvMessage(int fd, uint32_t& type, std::string& payload, size_t max_length) {
+    uint32_t header[3];
+    if (!recvAll(fd, header, sizeof(header)) || header[0] != ISLAND_MAGIC || header[2] > max_length) {
+        return false;
+    }
+    type = header[1];
+    payload.assign(header[2], '\0');
+    return header[2] == 0 || recvAll(fd, &payload[0], header[2]);
+}
+
+// "unix:/path" or "host:port"
+static int openSocket(std::string address, bool listening, int backlog) {
+    if (address.compare(0, 5, "unix:") == 0) {
+        std::string path = address.substr(5);
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Error: Unix socket path too long " << path << std::endl;
+            return -1;
+        }
+        std::strcpy(addr.sun_path, path.c_str());
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (listening) {
+            ::unlink(path.c_str());
+            if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, backlog) < 0) {
+                ::close(fd);
+                return -1;
+            }
+        } else if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        std::cerr << "Error: Expected host:port or unix:/path, got " << address << std::endl;
+        return -1;
+    }
+    std::string host = address.substr(0, colon);
+    std::string port = address.substr(colon + 1);
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listening ? AI_PASSIVE : 0;
+    addrinfo* result = nullptr;
+    if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0) {
+        std::cerr << "Error: Unable to resolve " << address << std::endl;
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        if (listening) {
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, backlog) == 0) {
+                break;
+            }
+        } else if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(result);
+    return fd;
+}
+
+//================================================================
+// Solution (de)serialization
+//================================================================
+IslandSolution captureSolution(FastSP* fastsp, double cost) {
+    IslandSolution solution;
+    solution.cost = cost;
+    solution.sp = fastsp->getSequencePair();
+    for (auto block : fastsp->getBlocks()) {
+        solution.rotated.push_back(block->isRotated());
+    }
+    return solution;
+}
+
+static std::string packSolution(const IslandSolution& solution) {
+    int32_t n = solution.rotated.size();
+    std::string payload;
+    payload.append(reinterpret_cast<const char*>(&solution.cost), sizeof(double));
+    payload.append(reinterpret_cast<const char*>(&n), sizeof(n));
+    for (int i = 1; i <= n; i++) {
+        int32_t v = solution.sp.x[i];
+        payload.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    for (int i = 1; i <= n; i++) {
+        int32_t v = solution.sp.y[i];
+        payload.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    std::string bits((n + 7) / 8, '\0');
+    for (int i = 0; i < n; i++) {
+        if (solution.rotated[i]) {
+            bits[i / 8] |= (1 << (i % 8));
+        }
+    }
+    payload += bits;
+    return payload;
+}
+
+// HELLO carries everything the cost of a solution depends on, so the
+// coordinator only compares costs of workers that agree on it
+static const size_t HELLO_SIZE = 3 * sizeof(int32_t) + sizeof(double);
+
+static std::string packHello(FastSP* fastsp) {
+    int32_t fields[3] = {fastsp->getNumBlocks(), fastsp->getOutline().width, fastsp->getOutline().height};
+    double alpha = fastsp->getAlpha();
+    std::string payload(reinterpret_cast<const char*>(fields), sizeof(fields));
+    payload.append(reinterpret_cast<const char*>(&alpha), sizeof(alpha));
+    return payload;
+}
+
+static bool unpackHello(const std::string& payload, int32_t fields[3], double& alpha) {
+    if (payload.size() != HELLO_SIZE) {
+        return false;
+    }
+    std::memcpy(fields, payload.data(), 3 * sizeof(int32_t));
+    std::memcpy(&alpha, payload.data() + 3 * sizeof(int32_t), sizeof(alpha));
+    return true;
+}
+
+static size_t solutionSize(int num_blocks) {
+    return sizeof(double) + sizeof(int32_t) + 2 * (size_t)num_blocks * sizeof(int32_t) + (num_blocks + 7) / 8;
+}
+
+static bool unpackSolution(const std::string& payload, int num_blocks, IslandSolution& solution) {
+    int32_t n = 0;
+    size_t expected = sizeof(double) + sizeof(n);
+    if (payload.size() < expected) {
+        return false;
+    }
+    std::memcpy(&solution.cost, payload.data(), sizeof(double));
+    std::memcpy(&n, payload.data() + sizeof(double), sizeof(n));
+    if (n != num_blocks || payload.size() != expected + 2 * n * sizeof(int32_t) + (n + 7) / 8) {
+        return false;
+    }
+    const char* p = payload.data() + expected;
+    solution.sp.x.assign(n + 1, 0);
+    solution.sp.y.assign(n + 1, 0);
+    std::memcpy(&solution.sp.x[1], p, n * sizeof(int32_t));
+    std::memcpy(&solution.sp.y[1], p + n * sizeof(int32_t), n * sizeof(int32_t));
+    p += 2 * n * sizeof(int32_t);
+
+    // Both sequences must be permutations of {1 ... n}
+    std::vector<char> seen_x(n + 1, 0), seen_y(n + 1, 0);
+    for (int i = 1; i <= n; i++) {
+        int x = solution.sp.x[i];
+        int y = solution.sp.y[i];
+        if (x < 1 || x > n || seen_x[x] || y < 1 || y > n || seen_y[y]) {
+            return false;
+        }
+        seen_x[x] = 1;
+        seen_y[y] = 1;
+    }
+    solution.rotated.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        solution.rotated[i] = (p[i / 8] >> (i % 8)) & 1;
+    }
+    return true;
+}
+
+//================================================================
+// Worker
+//================================================================
+IslandWorker::~IslandWorker() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool IslandWorker::connect(std::string address, FastSP* fastsp) {
+    // The coordinator may still be starting up
+    for (int attempt = 0; attempt < 50 && fd < 0; attempt++) {
+        fd = openSocket(address, false, 0);
+        if (fd < 0) {
+            ::usleep(100000);
+        }
+    }
+    if (fd < 0) {
+        std::cerr << "Error: Unable to connect to coordinator " << address << std::endl;
+        return false;
+    }
+
+    uint32_t type;
+    std::string payload;
+    if (!sendMessage(fd, MSG_HELLO, packHello(fastsp)) ||
+        !recvMessage(fd, type, payload, 2 * sizeof(int32_t)) || type != MSG_WELCOME || payload.size() != 2 * sizeof(int32_t)) {
+        std::cerr << "Error: Coordinator " << address << " rejected this worker" << std::endl;
+        return false;
+    }
+    int32_t ids[2];
+    std::memcpy(ids, payload.data(), sizeof(ids));
+    worker_id = ids[0];
+    num_workers = ids[1];
+    return true;
+}
+
+bool IslandWorker::exchange(const IslandSolution& mine, IslandSolution& migrant) {
+    uint32_t type;
+    std::string payload;
+    if (!sendMessage(fd, MSG_BEST, packSolution(mine)) ||
+        !recvMessage(fd, type, payload, solutionSize(mine.rotated.size())) || type != MSG_MIGRANT) {
+        std::cerr << "Error: Lost connection to coordinator" << std::endl;
+        return false;
+    }
+    return unpackSolution(payload, mine.rotated.size(), migrant);
+}
+
+bool IslandWorker::finish(const IslandSolution& mine) {
+    return sendMessage(fd, MSG_DONE, packSolution(mine));
+}
+
+//================================================================
+// Coordinator
+//================================================================
+// Workers are served in lockstep: one BEST (or DONE) is read from
+// every active worker, then every worker that sent BEST gets its
+// MIGRANT. Workers that finished early keep their final solution
+// available to the topology.
+//================================================================
+bool runCoordinator(std::string address, int num_workers, std::string topology,
+                    FastSP* fastsp, std::string output_file, double accept_timeout, double exchange_timeout) {
+    auto start = std::chrono::high_resolution_clock::now();
+    int listen_fd = openSocket(address, true, num_workers);
+    if (listen_fd < 0) {
+        std::cerr << "Error: Unable to listen on " << address << std::endl;
+        return false;
+    }
+    std::cout << "Coordinator listening on " << address << " for " << num_workers << " workers" << std::endl;
+
+    // Workers must connect and say hello before the deadline
+    int num_blocks = fastsp->getNumBlocks();
+    int32_t expected[3];
+    double expected_alpha;
+    unpackHello(packHello(fastsp), expected, expected_alpha);
+    std::vector<int> fds;
+    auto deadline = start + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(accept_timeout));
+    while ((int)fds.size() < num_workers) {
+        double remaining = std::chrono::duration_cast<std::chrono::duration<double>>(deadline - std::chrono::high_resolution_clock::now()).count();
+        pollfd listener = {listen_fd, POLLIN, 0};
+        if (remaining <= 0 || ::poll(&listener, 1, (int)(remaining * 1000) + 1) == 0) {
+            std::cerr << "Error: Only " << fds.size() << " of " << num_workers << " workers connected within " << accept_timeout << " Sec" << std::endl;
+            for (int fd : fds) {
+                ::close(fd);
+            }
+            ::close(listen_fd);
+            return false;
+        }
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        timeval hello_timeout = {(time_t)std::max(1.0, remaining), 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &hello_timeout, sizeof(hello_timeout));
+        uint32_t type;
+        std::string payload;
+        int32_t fields[3] = {-1, -1, -1};
+        double alpha = -1;
+        if (!recvMessage(fd, type, payload, HELLO_SIZE) || type != MSG_HELLO || !unpackHello(payload, fields, alpha)) {
+            std::cerr << "Warning: Rejected worker without a valid hello" << std::endl;
+            ::close(fd);
+            continue;
+        }
+        if (std::memcmp(fields, expected, sizeof(expected)) != 0 || alpha != expected_alpha) {
+            std::cerr << "Warning: Rejected worker with " << fields[0] << " blocks, outline " << fields[1] << " x " << fields[2]
+                      << " and alpha " << alpha << ", expected " << expected[0] << " blocks, outline " << expected[1]
+                      << " x " << expected[2] << " and alpha " << expected_alpha << std::endl;
+            ::close(fd);
+            continue;
+        }
+        // A worker that stalls between exchanges is dropped instead of
+        // holding up the lockstep of all the others
+        timeval exchange_wait = {(time_t)exchange_timeout, (suseconds_t)((exchange_timeout - (time_t)exchange_timeout) * 1e6)};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &exchange_wait, sizeof(exchange_wait));
+        int32_t ids[2] = {(int32_t)fds.size(), num_workers};
+        sendMessage(fd, MSG_WELCOME, std::string(reinterpret_cast<const char*>(ids), sizeof(ids)));
+        fds.push_back(fd);
+    }
+    ::close(listen_fd);
+
+    std::vector<IslandSolution> latest(num_workers);
+    std::vector<bool> has_solution(num_workers, false);
+    std::vector<bool> active(num_workers, true);
+    int num_active = num_workers;
+    int epoch = 0;
+    while (num_active > 0) {
+        std::vector<bool> waiting(num_workers, false);
+        for (int i = 0; i < num_workers; i++) {
+            if (!active[i]) {
+                continue;
+            }
+            uint32_t type;
+            std::string payload;
+            IslandSolution solution;
+            if (!recvMessage(fds[i], type, payload, solutionSize(num_blocks)) || !unpackSolution(payload, num_blocks, solution)) {
+                std::cerr << "Warning: Lost worker " << i << std::endl;
+                // Closed, so the worker does not wait for its migrant
+                ::close(fds[i]);
+                fds[i] = -1;
+                active[i] = false;
+                num_active--;
+                continue;
+            }
+            latest[i] = solution;
+            has_solution[i] = true;
+            if (type == MSG_DONE) {
+                active[i] = false;
+                num_active--;
+            } else {
+                waiting[i] = true;
+            }
+        }
+
+        int best = -1;
+        for (int i = 0; i < num_workers; i++) {
+            if (has_solution[i] && (best == -1 || latest[i].cost < latest[best].cost)) {
+                best = i;
+            }
+        }
+        if (best != -1) {
+            std::cout << "Epoch " << epoch << ": best cost " << latest[best].cost << " from worker " << best << std::endl;
+        }
+        for (int i = 0; i < num_workers; i++) {
+            if (!waiting[i]) {
+                continue;
+            }
+            int source = best;
+            if (topology == "ring") {
+                int prev = (i + num_workers - 1) % num_workers;
+                source = has_solution[prev] ? prev : i;
+            }
+            if (!sendMessage(fds[i], MSG_MIGRANT, packSolution(latest[source]))) {
+                std::cerr << "Warning: Lost worker " << i << std::endl;
+                ::close(fds[i]);
+                fds[i] = -1;
+                active[i] = false;
+                num_active--;
+            }
+        }
+        epoch++;
+    }
+    for (int fd : fds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    int best = -1;
+    for (int i = 0; i < num_workers; i++) {
+        if (has_solution[i] && (best == -1 || latest[i].cost < latest[best].cost)) {
+            best = i;
+        }
+    }
+    if (best == -1) {
+        std::cerr << "Error: No worker reported a solution" << std::endl;
+        return false;
+    }
+    fastsp->setSolution(latest[best].sp, latest[best].rotated);
+    double runtime = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+    fastsp->outputDump(output_file, runtime);
+    std::cout << "Elapsed: " << runtime << " Sec" << std::endl;
+    return true;
+}
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <omp.h>
+#include "multilevel.h"
+
+struct ClusterNode {
+    int w;
+    int h;
+    int first;          // Child in the finer level, -1 on the flat level
+    int second;         // Second child, -1 if the node is carried over alone
+    bool horizontal;    // first left of second, otherwise first below second
+    bool first_rotated; // Children rotated relative to the finer level
+    bool second_rotated;
+};
+
+struct ClusterLevel {
+    std::vector<ClusterNode> nodes;
+    std::vector<std::vector<int>> net_nodes;
+    std::vector<std::vector<int>> net_terminals;
+};
+
+static long long nodeArea(const ClusterNode& node) {
+    return (long long)node.w * node.h;
+}
+
+static ClusterLevel flatLevel(FastSP* flat) {
+    ClusterLevel level;
+    std::vector<Block*>& blocks = flat->getBlocks();
+    std::vector<Terminal*>& terminals = flat->getTerminals();
+    std::unordered_map<Block*, int> block_index;
+    std::unordered_map<Terminal*, int> terminal_index;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        Block* block = blocks[i];
+        int w = block->isRotated() ? block->getHeight() : block->getWidth();
+        int h = block->isRotated() ? block->getWidth() : block->getHeight();
+        level.nodes.push_back({w, h, -1, -1, true, false, false});
+        block_index[block] = i;
+    }
+    for (size_t i = 0; i < terminals.size(); i++) {
+        terminal_index[terminals[i]] = i;
+    }
+    for (auto net : flat->getNets()) {
+        std::vector<int> nodes, pins;
+        for (auto block : net->blocks) {
+            nodes.push_back(block_index[block]);
+        }
+        for (auto terminal : net->terminals) {
+            pins.push_back(terminal_index[terminal]);
+        }
+        level.net_nodes.push_back(nodes);
+        level.net_terminals.push_back(pins);
+    }
+    return level;
+}
+
+//================================================================
+// Coarsening by heavy-edge matching
+//================================================================
+// Nodes are visited from the smallest area up. A node is merged with
+// the unmatched neighbor maximizing connectivity * area similarity,
+// or, if it has none, with the next unmatched node of similar area.
+// Merged areas are capped so clusters stay balanced.
+//================================================================
+static ClusterLevel coarsen(const ClusterLevel& fine, int target_clusters) {
+    int n = fine.nodes.size();
+    std::vector<std::unordered_map<int, double>> adj(n);
+    for (auto& net : fine.net_nodes) {
+        int degree = net.size();
+        if (degree < 2 || degree > 64) {
+            continue;
+        }
+        double w = 1.0 / (degree - 1);
+        for (int a = 0; a < degree; a++) {
+            for (int b = a + 1; b < degree; b++) {
+                if (net[a] != net[b]) {
+                    adj[net[a]][net[b]] += w;
+                    adj[net[b]][net[a]] += w;
+                }
+            }
+        }
+    }
+
+    long long total_area = 0;
+    for (auto& node : fine.nodes) {
+        total_area += nodeArea(node);
+    }
+    long long cap = std::max(2 * total_area / std::max(1, target_clusters), 1LL);
+
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return nodeArea(fine.nodes[a]) < nodeArea(fine.nodes[b]);
+    });
+
+    ClusterLevel coarse;
+    std::vector<int> parent(n, -1);
+    size_t next_free = 0;
+    for (int u : order) {
+        if (parent[u] != -1) {
+            continue;
+        }
+        long long area_u = nodeArea(fine.nodes[u]);
+        int best = -1;
+        double best_score = 0.0;
+        for (auto& e : adj[u]) {
+            int v = e.first;
+            long long area_v = nodeArea(fine.nodes[v]);
+            if (parent[v] != -1 || area_u + area_v > cap) {
+                continue;
+            }
+            double similarity = (double)std::min(area_u, area_v) / std::max(std::max(area_u, area_v), 1LL);
+            double score = e.second * similarity;
+            if (score > best_score) {
+                best_score = score;
+                best = v;
+            }
+        }
+        if (best == -1 && adj[u].empty()) {
+            while (next_free < order.size() && (parent[order[next_free]] != -1 || order[next_free] == u)) {
+                next_free++;
+            }
+            if (next_free < order.size() && area_u + nodeArea(fine.nodes[order[next_free]]) <= cap) {
+                best = order[next_free];
+            }
+        }
+
+        int id = coarse.nodes.size();
+        parent[u] = id;
+        if (best == -1) {
+            coarse.nodes.push_back({fine.nodes[u].w, fine.nodes[u].h, u, -1, true, false, false});
+            continue;
+        }
+        parent[best] = id;
+
+        // Side by side or stacked, with either child rotated, whichever
+        // leaves the least dead space, the squarer one on a tie
+        ClusterNode merged = {0, 0, u, best, true, false, false};
+        long long merged_area = LLONG_MAX;
+        for (int k = 0; k < 8; k++) {
+            bool horizontal = k & 1;
+            bool rot_a = (k >> 1) & 1;
+            bool rot_b = (k >> 2) & 1;
+            int aw = rot_a ? fine.nodes[u].h : fine.nodes[u].w;
+            int ah = rot_a ? fine.nodes[u].w : fine.nodes[u].h;
+            int bw = rot_b ? fine.nodes[best].h : fine.nodes[best].w;
+            int bh = rot_b ? fine.nodes[best].w : fine.nodes[best].h;
+            int w = horizontal ? aw + bw : std::max(aw, bw);
+            int h = horizontal ? std::max(ah, bh) : ah + bh;
+            long long area = (long long)w * h;
+            if (area < merged_area || (area == merged_area && std::abs(w - h) < std::abs(merged.w - merged.h))) {
+                merged_area = area;
+                merged = {w, h, u, best, horizontal, rot_a, rot_b};
+            }
+        }
+        coarse.nodes.push_back(merged);
+    }
+
+    // Nets on the coarse level, internal nets without terminals vanish
+    for (size_t i = 0; i < fine.net_nodes.size(); i++) {
+        std::vector<int> nodes;
+        for (int v : fine.net_nodes[i]) {
+            nodes.push_back(parent[v]);
+        }
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+        if (nodes.size() + fine.net_terminals[i].size() < 2) {
+            continue;
+        }
+        coarse.net_nodes.push_back(nodes);
+        coarse.net_terminals.push_back(fine.net_terminals[i]);
+    }
+    return coarse;
+}
+
+//================================================================
+// Uncoarsening
+//================================================================
+// Sequence pair entries are node ids + 1, rotations are indexed by
+// node id.
+//================================================================
+static void project(const ClusterLevel& coarse, const SequencePair& coarse_sp, const std::vector<char>& coarse_rotated,
+                    int num_fine, SequencePair& fine_sp, std::vector<char>& fine_rotated) {
+    fine_sp.x.assign(1, 0);
+    fine_sp.y.assign(1, 0);
+    fine_rotated.assign(num_fine, 0);
+    for (size_t k = 1; k < coarse_sp.x.size(); k++) {
+        const ClusterNode& node = coarse.nodes[coarse_sp.x[k] - 1];
+        bool rotated = coarse_rotated[coarse_sp.x[k] - 1];
+        if (node.second == -1) {
+            fine_sp.x.push_back(node.first + 1);
+        } else if (node.horizontal != rotated) {
+            fine_sp.x.push_back(node.first + 1);
+            fine_sp.x.push_back(node.second + 1);
+        } else {
+            fine_sp.x.push_back(node.second + 1);
+            fine_sp.x.push_back(node.first + 1);
+        }
+    }
+    for (size_t k = 1; k < coarse_sp.y.size(); k++) {
+        int id = coarse_sp.y[k] - 1;
+        const ClusterNode& node = coarse.nodes[id];
+        fine_sp.y.push_back(node.first + 1);
+        fine_rotated[node.first] = coarse_rotated[id] != node.first_rotated;
+        if (node.second != -1) {
+            fine_sp.y.push_back(node.second + 1);
+            fine_rotated[node.second] = coarse_rotated[id] != node.second_rotated;
+        }
+    }
+}
+
+// Clusters contain dead space, the outline is scaled up by the same
+// factor so coarse levels are not over-constrained
+static FastSP* buildLevel(FastSP* flat, const ClusterLevel& level, double area_ratio) {
+    Outline outline = flat->getOutline();
+    double scale = std::sqrt(area_ratio);
+    outline.width = outline.width * scale;
+    outline.height = outline.height * scale;
+    FastSP* fastsp = new FastSP(flat->getAlpha(), outline);
+    for (size_t i = 0; i < level.nodes.size(); i++) {
+        fastsp->addBlock("c" + std::to_string(i), level.nodes[i].w, level.nodes[i].h);
+    }
+    std::vector<Terminal*>& terminals = flat->getTerminals();
+    for (auto terminal : terminals) {
+        fastsp->addTerminal(terminal->getName(), terminal->getCoord()->x, terminal->getCoord()->y);
+    }
+    // By id: the cluster names may be taken by terminals of the design
+    for (size_t i = 0; i < level.net_nodes.size(); i++) {
+        fastsp->addNet(level.net_nodes[i], level.net_terminals[i]);
+    }
+    fastsp->selectCostTypes();
+    fastsp->selectCostModel();
+    return fastsp;
+}
+
+bool runMultilevel(FastSP* flat, const MultilevelOptions& opt, SequencePair& sp, std::vector<char>& rotated) {
+    std::vector<ClusterLevel> levels;
+    levels.push_back(flatLevel(flat));
+    while ((int)levels.back().nodes.size() > opt.target_clusters) {
+        ClusterLevel coarse = coarsen(levels.back(), opt.target_clusters);
+        if (coarse.nodes.size() * 10 > levels.back().nodes.size() * 9) {
+            break;
+        }
+        levels.push_back(coarse);
+    }
+    if (levels.size() == 1) {
+        if (opt.verbose) {
+            std::cout << "Multilevel: design already has " << levels[0].nodes.size() << " blocks, no coarsening" << std::endl;
+        }
+        return false;
+    }
+
+    long long flat_area = 0;
+    for (auto& node : levels[0].nodes) {
+        flat_area += nodeArea(node);
+    }
+
+    SequencePair level_sp;
+    std::vector<char> level_rotated;
+    std::vector<FastSP*> replicas(opt.num_replicas);
+    std::vector<double> costs(opt.num_replicas);
+    for (int l = levels.size() - 1; l >= 1; l--) {
+        long long level_area = 0;
+        for (auto& node : levels[l].nodes) {
+            level_area += nodeArea(node);
+        }
+        double area_ratio = (double)level_area / std::max(flat_area, 1LL);
+
+        #pragma omp parallel for num_threads(opt.num_replicas) schedule(static)
+        for (int i = 0; i < opt.num_replicas; ++i) {
+            FastSP* fastsp = buildLevel(flat, levels[l], area_ratio);
+            if (opt.seeded) {
+                fastsp->setSeed(FastSP::splitSeed(opt.master_seed + l, i));
+            }
+            if (l == (int)levels.size() - 1) {
+                fastsp->initializeShelf();
+            } else {
+                fastsp->setSolution(level_sp, level_rotated);
+                fastsp->initRng();
+                fastsp->setInitTemp(opt.refine_temp);
+                // Start legal: refinement optimizes the projected packing
+                // instead of searching for a fit from scratch
+                Outline outline = fastsp->getOutline();
+                outline.width = std::max<long long>(outline.width, fastsp->evalSequencePair(false));
+                outline.height = std::max<long long>(outline.height, fastsp->evalSequencePair(true));
+                fastsp->setOutline(outline);
+            }
+            costs[i] = fastsp->runFastSP(opt.level_time, opt.level_iterations);
+            replicas[i] = fastsp;
+        }
+
+        int best = 0;
+        for (int i = 1; i < opt.num_replicas; ++i) {
+            if (costs[i] < costs[best]) {
+                best = i;
+            }
+        }
+        if (opt.verbose) {
+            std::cout << "Level " << l << ": " << levels[l].nodes.size() << " clusters, cost " << costs[best] << std::endl;
+        }
+
+        SequencePair coarse_sp = replicas[best]->getSequencePair();
+        std::vector<char> coarse_rotated;
+        for (auto block : replicas[best]->getBlocks()) {
+            coarse_rotated.push_back(block->isRotated());
+        }
+        project(levels[l], coarse_sp, coarse_rotated, levels[l-1].nodes.size(), level_sp, level_rotated);
+
+        for (int i = 0; i < opt.num_replicas; ++i) {
+            delete replicas[i];
+        }
+    }
+
+    sp = level_sp;
+    rotated = level_rotated;
+    return true;
+}
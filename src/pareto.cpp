@@ -0,0 +1,76 @@
+#include <algorithm>
+#include "pareto.h"
+
+// First entry with an area above `area`
+static std::vector<ParetoEntry>::iterator upperByArea(std::vector<ParetoEntry>& entries, long long area) {
+    return std::upper_bound(entries.begin(), entries.end(), area, [](long long a, const ParetoEntry& e) {
+        return a < e.area;
+    });
+}
+
+bool ParetoArchive::dominated(long long area, long long wirelength) {
+    auto it = upperByArea(entries, area);
+    return it != entries.begin() && std::prev(it)->wirelength <= wirelength;
+}
+
+bool ParetoArchive::offer(FastSP* fastsp, long long width, long long height, long long wirelength) {
+    return offer(fastsp, width, height, wirelength, fastsp->getAlpha());
+}
+
+bool ParetoArchive::offer(FastSP* fastsp, long long width, long long height, long long wirelength, double alpha) {
+    if (dominated(width * height, wirelength)) {
+        return false;
+    }
+    ParetoEntry entry;
+    entry.area = width * height;
+    entry.wirelength = wirelength;
+    entry.width = width;
+    entry.height = height;
+    entry.alpha = alpha;
+    fastsp->packSolution(entry.solution);
+    entry.solution.tag = FastSP::freshSolutionTag();
+    return insert(entry);
+}
+
+bool ParetoArchive::insert(const ParetoEntry& entry) {
+    if (dominated(entry.area, entry.wirelength)) {
+        return false;
+    }
+    // Entries from the insertion point on with an HPWL not below the
+    // new one are dominated by it, and they are contiguous
+    auto first = std::lower_bound(entries.begin(), entries.end(), entry.area, [](const ParetoEntry& e, long long a) {
+        return e.area < a;
+    });
+    auto last = first;
+    while (last != entries.end() && last->wirelength >= entry.wirelength) {
+        ++last;
+    }
+    first = entries.erase(first, last);
+    entries.insert(first, entry);
+    if (entries.size() > capacity) {
+        thin();
+    }
+    return true;
+}
+
+void ParetoArchive::merge(const ParetoArchive& other) {
+    for (auto& entry : other.entries) {
+        insert(entry);
+    }
+}
+
+void ParetoArchive::thin() {
+    double area_range = std::max(1.0, (double)(entries.back().area - entries.front().area));
+    double wire_range = std::max(1.0, (double)(entries.front().wirelength - entries.back().wirelength));
+    size_t victim = 1;
+    double closest = 1e300;
+    for (size_t i = 1; i + 1 < entries.size(); i++) {
+        double gap = (entries[i+1].area - entries[i-1].area) / area_range +
+                     (entries[i-1].wirelength - entries[i+1].wirelength) / wire_range;
+        if (gap < closest) {
+            closest = gap;
+            victim = i;
+        }
+    }
+    entries.erase(entries.begin() + victim);
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "checkpoint.h"
+
+// Checkpoint round trip: a restored replica anneals exactly like the
+// one that was saved. Truncated files and replica states with a wrong
+// RNG state length must be rejected.
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "Fail: " << what << std::endl;
+        failures++;
+    }
+}
+
+static FastSP* buildReplica(uint32_t seed) {
+    FastSP* fastsp = new FastSP(0.5, Outline{60, 60});
+    int sizes[][2] = {{10, 20}, {15, 15}, {30, 10}, {8, 25}, {20, 20}, {12, 6}, {25, 14}, {9, 9}, {18, 11}, {7, 30}};
+    for (int i = 0; i < 10; i++) {
+        fastsp->addBlock("b" + std::to_string(i), sizes[i][0], sizes[i][1]);
+    }
+    fastsp->addTerminal("t0", 0, 30);
+    fastsp->addNet({0, 3, 5}, {0});
+    fastsp->addNet({1, 2, 8, 9}, {});
+    fastsp->addNet({4, 6, 7}, {});
+    fastsp->selectCostTypes();
+    fastsp->selectCostModel();
+    fastsp->setSeed(seed);
+    fastsp->initialize();
+    return fastsp;
+}
+
+static bool sameSolution(FastSP* a, FastSP* b) {
+    SequencePair sa = a->getSequencePair();
+    SequencePair sb = b->getSequencePair();
+    if (sa.x != sb.x || sa.y != sb.y) {
+        return false;
+    }
+    for (int i = 0; i < a->getNumBlocks(); i++) {
+        if (a->getBlocks()[i]->isRotated() != b->getBlocks()[i]->isRotated()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static void writeFile(const std::string& filename, const std::string& content) {
+    std::ofstream file(filename, std::ios::binary);
+    file.write(content.data(), content.size());
+}
+
+int main() {
+    const std::string filename = "test_checkpoint.ckpt";
+    std::vector<FastSP*> saved = {buildReplica(11), buildReplica(12)};
+    std::vector<double> costs;
+    for (FastSP* fastsp : saved) {
+        costs.push_back(fastsp->runFastSP(0, 20));
+    }
+    check(saveCheckpoint(filename, saved, {3, 1, costs, {}}), "save");
+
+    // Round trip
+    std::vector<FastSP*> restored = {buildReplica(0), buildReplica(0)};
+    Checkpoint ckpt;
+    check(loadCheckpoint(filename, restored, ckpt), "load");
+    check(ckpt.next_round == 3 && ckpt.best_index == 1 && ckpt.costs == costs, "header and costs");
+    for (int i = 0; i < 2 && (int)ckpt.states.size() == 2; i++) {
+        std::string replica = "replica " + std::to_string(i);
+        check(loadReplicaState(restored[i], ckpt.states[i]), replica + " state");
+        check(sameSolution(saved[i], restored[i]), replica + " solution");
+        check(restored[i]->getSeed() == saved[i]->getSeed(), replica + " seed");
+        // Same RNG state, so the next round takes the same moves
+        double saved_cost = saved[i]->runFastSP(0, 20);
+        double restored_cost = restored[i]->runFastSP(0, 20);
+        check(saved_cost == restored_cost && sameSolution(saved[i], restored[i]), replica + " continues alike");
+    }
+
+    // Errors are expected from here on
+    std::ostringstream errors;
+    std::streambuf* cerr_buf = std::cerr.rdbuf(errors.rdbuf());
+
+    // Every truncation fails, from the header to the last byte
+    std::string content = readFile(filename);
+    std::string truncated = filename + ".truncated";
+    int truncations_loaded = 0;
+    for (size_t len = 0; len < content.size(); len++) {
+        writeFile(truncated, content.substr(0, len));
+        Checkpoint partial;
+        if (loadCheckpoint(truncated, restored, partial)) {
+            truncations_loaded++;
+        }
+    }
+    std::remove(truncated.c_str());
+
+    // The RNG state length follows seed, init_temp and the warm start
+    // flag at the start of a replica state
+    std::string state = ckpt.states.empty() ? std::string() : ckpt.states[0];
+    const size_t rng_len_offset = sizeof(uint32_t) + sizeof(double) + sizeof(uint8_t);
+    uint32_t rng_len = 0;
+    if (state.size() >= rng_len_offset + sizeof(rng_len)) {
+        std::memcpy(&rng_len, &state[rng_len_offset], sizeof(rng_len));
+    }
+    uint32_t wrong_lengths[] = {0, rng_len - 1, rng_len + 1, rng_len + 64, 0xFFFFFFFFu};
+    int wrong_loaded = 0;
+    for (uint32_t wrong : wrong_lengths) {
+        std::string corrupted = state;
+        std::memcpy(&corrupted[rng_len_offset], &wrong, sizeof(wrong));
+        FastSP* replica = buildReplica(0);
+        if (loadReplicaState(replica, corrupted)) {
+            wrong_loaded++;
+        }
+        delete replica;
+    }
+    std::cerr.rdbuf(cerr_buf);
+    std::remove(filename.c_str());
+
+    check(rng_len > 0, "RNG state length");
+    check(truncations_loaded == 0, std::to_string(truncations_loaded) + " truncated files loaded");
+    check(wrong_loaded == 0, std::to_string(wrong_loaded) + " wrong RNG state lengths loaded");
+
+    for (int i = 0; i < 2; i++) {
+        delete saved[i];
+        delete restored[i];
+    }
+    if (failures > 0) {
+        std::cerr << failures << " checkpoint checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Checkpoint: Pass" << std::endl;
+    return 0;
+}
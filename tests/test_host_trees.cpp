@@ -0,0 +1,100 @@
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include "bst.h"
+
+// Differential test of the host trees against std::set. Every query
+// of a random insert/remove sequence must give the same answer, with
+// the contract of the kernel: inserts of absent values, removes of
+// present ones, queries within [0, upper_bound].
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "Fail: " << what << std::endl;
+        failures++;
+    }
+}
+
+static int successorOf(const std::set<int>& ref, int value) {
+    auto it = ref.upper_bound(value);
+    return it == ref.end() ? -1 : *it;
+}
+
+static int predecessorOf(const std::set<int>& ref, int value) {
+    auto it = ref.lower_bound(value);
+    return it == ref.begin() ? -1 : *std::prev(it);
+}
+
+template <class HostTree>
+static void compare(HostTree& host, const std::set<int>& ref, int upper_bound, const std::string& name, std::mt19937& rng) {
+    int min_v = ref.empty() ? -1 : *ref.begin();
+    int max_v = ref.empty() ? -1 : *ref.rbegin();
+    check(host.minimum() == min_v, name + " minimum");
+    check(host.maximum() == max_v, name + " maximum");
+    // The ends and their neighbors, then random values
+    int probes[] = {0, 1, upper_bound - 1, upper_bound, min_v, max_v};
+    for (int value : probes) {
+        if (value < 0 || value > upper_bound) {
+            continue;
+        }
+        check(host.successor(value) == successorOf(ref, value), name + " successor of " + std::to_string(value));
+        check(host.predecessor(value) == predecessorOf(ref, value), name + " predecessor of " + std::to_string(value));
+    }
+    std::uniform_int_distribution<int> any_value(0, upper_bound);
+    for (int k = 0; k < 8; k++) {
+        int value = any_value(rng);
+        check(host.successor(value) == successorOf(ref, value), name + " successor of " + std::to_string(value));
+        check(host.predecessor(value) == predecessorOf(ref, value), name + " predecessor of " + std::to_string(value));
+    }
+}
+
+template <class HostTree>
+static void run(const std::string& name) {
+    std::mt19937 rng(1);
+    HostTree host;
+    // Word and cluster boundaries, and a host reset to the same bound
+    int bounds[] = {1, 2, 63, 64, 65, 127, 128, 200, 4095, 4096, 4097, 4097, 20000, 64};
+    for (int upper_bound : bounds) {
+        host.reset(upper_bound);
+        std::set<int> ref;
+        std::string label = name + " [0, " + std::to_string(upper_bound) + "]";
+        compare(host, ref, upper_bound, label, rng);
+        std::uniform_int_distribution<int> any_value(0, upper_bound);
+        for (int step = 0; step < 3000; step++) {
+            // Grow to about half full, then shrink back to empty
+            bool grow = step < 1500 ? rng() % 4 != 0 : rng() % 4 == 0;
+            if (grow && (int)ref.size() <= upper_bound) {
+                int value = any_value(rng);
+                while (ref.count(value)) {
+                    value = value == upper_bound ? 0 : value + 1;
+                }
+                host.insert(value);
+                ref.insert(value);
+            } else if (!ref.empty()) {
+                auto it = ref.lower_bound(any_value(rng));
+                if (it == ref.end()) {
+                    it = ref.begin();
+                }
+                host.remove(*it);
+                ref.erase(it);
+            }
+            compare(host, ref, upper_bound, label, rng);
+        }
+    }
+}
+
+int main() {
+    run<FastBitSetTree>("flat");
+    run<HierBitSetTree>("hier");
+    run<FenwickTree>("fenwick");
+    run<VebTree>("veb");
+    if (failures > 0) {
+        std::cerr << failures << " host tree checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Host trees: Pass" << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "island.h"
+
+// Message framing of the island protocol over a socket pair. A length
+// prefix above the expected size must fail before the payload is
+// allocated or read, as must a bad magic and a connection that closes
+// mid-payload.
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "Fail: " << what << std::endl;
+        failures++;
+    }
+}
+
+static bool sendHeader(int fd, uint32_t magic, uint32_t type, uint32_t length) {
+    uint32_t header[3] = {magic, type, length};
+    return ::send(fd, header, sizeof(header), 0) == sizeof(header);
+}
+
+int main() {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        std::cerr << "Error: Unable to create a socket pair" << std::endl;
+        return 1;
+    }
+    uint32_t type = 0;
+    std::string payload;
+
+    // Round trip, with and without a payload
+    check(sendMessage(fds[0], 3, "payload"), "send");
+    check(recvMessage(fds[1], type, payload, 16) && type == 3 && payload == "payload", "round trip");
+    check(sendMessage(fds[0], 5, ""), "send empty");
+    check(recvMessage(fds[1], type, payload, 16) && type == 5 && payload.empty(), "empty round trip");
+
+    // Exactly the limit is accepted, one byte more is not
+    check(sendMessage(fds[0], 4, std::string(16, 'x')), "send at limit");
+    check(recvMessage(fds[1], type, payload, 16) && payload.size() == 16, "payload at limit");
+
+    // Oversized length prefixes, none followed by a payload. A reader
+    // that trusted them would block on the payload or allocate 4 GB.
+    uint32_t oversized[] = {17, 1u << 20, 0xFFFFFFFFu};
+    for (uint32_t length : oversized) {
+        payload = "untouched";
+        sendHeader(fds[0], ISLAND_MAGIC, 3, length);
+        check(!recvMessage(fds[1], type, payload, 16), "length " + std::to_string(length) + " rejected");
+        check(payload == "untouched", "length " + std::to_string(length) + " not allocated");
+    }
+
+    // Wrong magic
+    sendHeader(fds[0], ISLAND_MAGIC ^ 1, 3, 0);
+    check(!recvMessage(fds[1], type, payload, 16), "bad magic rejected");
+
+    // The peer closes after half of the announced payload
+    sendHeader(fds[0], ISLAND_MAGIC, 3, 8);
+    ::send(fds[0], "half", 4, 0);
+    ::close(fds[0]);
+    check(!recvMessage(fds[1], type, payload, 16), "short payload rejected");
+    check(!recvMessage(fds[1], type, payload, 16), "closed connection rejected");
+    ::close(fds[1]);
+
+    if (failures > 0) {
+        std::cerr << failures << " island checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Island framing: Pass" << std::endl;
+    return 0;
+}